@@ -9,6 +9,8 @@
     Call destructor(arr) in order to clean up.
     If array goes out of scope without destructor being called, a memory leak will occur.
 
+    To use one instantiation from several files see DECLARE_ARRAY in README.
+
     example:
 
     ARRAY(int)
@@ -60,6 +62,10 @@
 #endif
 
 #define ARRAY(type)                                                         \
+    DECLARE_ARRAY(type)                                                     \
+    DEFINE_ARRAY(type)
+
+#define DECLARE_ARRAY(type)                                                 \
 typedef struct array_##type                                                 \
 {                                                                           \
     type*  _array;                                                          \
@@ -80,6 +86,20 @@ typedef struct array_##type                                                 \
     void   (*shrink)(struct array_##type*);                                 \
 } array_##type;                                                             \
                                                                             \
+void   array_push_##type(struct array_##type*, type);                       \
+void   array_insert_##type(struct array_##type*, type, size_t);             \
+void   array_pop_back_##type(struct array_##type*);                         \
+size_t array_erase_##type(struct array_##type*, size_t);                    \
+type   array_front_##type(struct array_##type*);                            \
+type   array_back_##type(struct array_##type*);                             \
+type   array_get_##type(struct array_##type*, size_t);                      \
+bool   array_empty_##type(struct array_##type*);                            \
+size_t array_size_##type(struct array_##type*);                             \
+void   array_clear_##type(struct array_##type*);                            \
+void   array_reserve_##type(struct array_##type*, size_t);                  \
+void   array_shrink_##type(struct array_##type*);
+
+#define DEFINE_ARRAY(type)                                                  \
 void array_push_##type(struct array_##type* arr, type elem)                 \
 {                                                                           \
     if (arr->_elements >= arr->_capacity)                                   \
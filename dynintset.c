@@ -0,0 +1,635 @@
+#include "dynintset.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define r_popcount(word) ((uint32_t)__builtin_popcountll(word))
+    #define r_ctz(word)      ((uint32_t)__builtin_ctzll(word))
+#else
+    static uint32_t r_popcount(uint64_t word)
+    {
+        uint32_t count = 0;
+        for (; word; word &= word - 1)
+            count++;
+        return count;
+    }
+    static uint32_t r_ctz(uint64_t word)
+    {
+        uint32_t count = 0;
+        for (; !(word & 1); word >>= 1)
+            count++;
+        return count;
+    }
+#endif
+
+// container level
+
+static uint32_t r_lower_bound(const uint16_t* values, uint32_t n, uint16_t low)
+{
+    uint32_t lo = 0, hi = n;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (values[mid] < low)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static bool r_container_contains(const IntContainer* c, uint16_t low)
+{
+    if (c->kind == INT_CONTAINER_ARRAY)
+    {
+        const uint16_t* values = c->data;
+        uint32_t pos = r_lower_bound(values, c->n, low);
+        return pos < c->n && values[pos] == low;
+    }
+    else if (c->kind == INT_CONTAINER_BITMAP)
+    {
+        const uint64_t* words = c->data;
+        return (words[low >> 6] >> (low & 63)) & 1;
+    }
+    else
+    {
+        const IntRun* runs = c->data;
+        uint32_t lo = 0, hi = c->n;
+        while (lo < hi)
+        {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (runs[mid].start <= low)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo > 0 && low - runs[lo - 1].start <= runs[lo - 1].length;
+    }
+}
+
+static void r_set_range(uint64_t* words, uint32_t start, uint32_t end)
+{
+    for (uint32_t w = start >> 6; w <= (end >> 6); w++)
+    {
+        uint64_t mask = ~0ULL;
+        if (w == (start >> 6))
+            mask &= ~0ULL << (start & 63);
+        if (w == (end >> 6))
+            mask &= ~0ULL >> (63 - (end & 63));
+        words[w] |= mask;
+    }
+}
+
+// writes the container as a full bitmap into words
+static void r_words(const IntContainer* c, uint64_t* words)
+{
+    if (c->kind == INT_CONTAINER_BITMAP)
+    {
+        memcpy(words, c->data, sizeof(uint64_t) * INT_SET_WORDS);
+        return;
+    }
+
+    memset(words, 0, sizeof(uint64_t) * INT_SET_WORDS);
+
+    if (c->kind == INT_CONTAINER_ARRAY)
+    {
+        const uint16_t* values = c->data;
+        for (uint32_t i = 0; i < c->n; i++)
+            words[values[i] >> 6] |= 1ULL << (values[i] & 63);
+    }
+    else
+    {
+        const IntRun* runs = c->data;
+        for (uint32_t i = 0; i < c->n; i++)
+            r_set_range(words, runs[i].start, (uint32_t)runs[i].start + runs[i].length);
+    }
+}
+
+// writes the container's values in ascending order into out, returns the count
+static uint32_t r_extract(const IntContainer* c, uint16_t* out)
+{
+    uint32_t k = 0;
+
+    if (c->kind == INT_CONTAINER_ARRAY)
+    {
+        memcpy(out, c->data, sizeof(uint16_t) * c->n);
+        k = c->n;
+    }
+    else if (c->kind == INT_CONTAINER_BITMAP)
+    {
+        const uint64_t* words = c->data;
+        for (uint32_t i = 0; i < INT_SET_WORDS; i++)
+        {
+            for (uint64_t w = words[i]; w; w &= w - 1)
+                out[k++] = (uint16_t)(i * 64 + r_ctz(w));
+        }
+    }
+    else
+    {
+        const IntRun* runs = c->data;
+        for (uint32_t i = 0; i < c->n; i++)
+        {
+            for (uint32_t v = runs[i].start; v <= (uint32_t)runs[i].start + runs[i].length; v++)
+                out[k++] = (uint16_t)v;
+        }
+    }
+
+    return k;
+}
+
+static void r_to_bitmap(IntContainer* c)
+{
+    uint64_t* words = malloc(sizeof(uint64_t) * INT_SET_WORDS);
+    assert(words != NULL);
+    r_words(c, words);
+
+    free(c->data);
+    c->data = words;
+    c->kind = INT_CONTAINER_BITMAP;
+    c->n = 0;
+    c->capacity = 0;
+}
+
+static void r_to_array(IntContainer* c)
+{
+    uint16_t* values = malloc(sizeof(uint16_t) * (c->cardinality > 0 ? c->cardinality : 1));
+    assert(values != NULL);
+    r_extract(c, values);
+
+    free(c->data);
+    c->data = values;
+    c->kind = INT_CONTAINER_ARRAY;
+    c->n = c->cardinality;
+    c->capacity = c->cardinality;
+}
+
+// run containers are read-only, they are expanded before any modification
+static void r_materialize(IntContainer* c)
+{
+    if (c->kind != INT_CONTAINER_RUN)
+        return;
+
+    if (c->cardinality > INT_SET_ARRAY_MAX)
+        r_to_bitmap(c);
+    else
+        r_to_array(c);
+}
+
+// takes ownership of words and returns the smallest of array/bitmap for them
+static IntContainer r_pack(uint16_t key, uint64_t* words, uint32_t cardinality)
+{
+    IntContainer c = { key, INT_CONTAINER_BITMAP, cardinality, 0, 0, words };
+
+    if (cardinality <= INT_SET_ARRAY_MAX)
+        r_to_array(&c);
+
+    return c;
+}
+
+static IntContainer r_clone(const IntContainer* c)
+{
+    IntContainer copy = *c;
+    size_t bytes;
+
+    if (c->kind == INT_CONTAINER_ARRAY)
+        bytes = sizeof(uint16_t) * c->n;
+    else if (c->kind == INT_CONTAINER_BITMAP)
+        bytes = sizeof(uint64_t) * INT_SET_WORDS;
+    else
+        bytes = sizeof(IntRun) * c->n;
+
+    copy.data = malloc(bytes > 0 ? bytes : 1);
+    assert(copy.data != NULL);
+    memcpy(copy.data, c->data, bytes);
+    copy.capacity = (c->kind == INT_CONTAINER_BITMAP) ? 0 : c->n;
+
+    return copy;
+}
+
+typedef enum IntSetOp
+{
+    INT_SET_OR,
+    INT_SET_AND,
+    INT_SET_ANDNOT
+} IntSetOp;
+
+static IntContainer r_filter(const IntContainer* array, const IntContainer* other, bool keep_if_present)
+{
+    const uint16_t* values = array->data;
+    uint16_t* out = malloc(sizeof(uint16_t) * (array->n > 0 ? array->n : 1));
+    assert(out != NULL);
+
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < array->n; i++)
+    {
+        if (r_container_contains(other, values[i]) == keep_if_present)
+            out[k++] = values[i];
+    }
+
+    IntContainer c = { array->key, INT_CONTAINER_ARRAY, k, k, array->n, out };
+    return c;
+}
+
+static IntContainer r_merge(const IntContainer* a, const IntContainer* b)
+{
+    const uint16_t* va = a->data;
+    const uint16_t* vb = b->data;
+    uint16_t* out = malloc(sizeof(uint16_t) * (a->n + b->n > 0 ? a->n + b->n : 1));
+    assert(out != NULL);
+
+    uint32_t i = 0, j = 0, k = 0;
+    while (i < a->n && j < b->n)
+    {
+        if (va[i] < vb[j])
+            out[k++] = va[i++];
+        else if (vb[j] < va[i])
+            out[k++] = vb[j++];
+        else
+        {
+            out[k++] = va[i++];
+            j++;
+        }
+    }
+    while (i < a->n)
+        out[k++] = va[i++];
+    while (j < b->n)
+        out[k++] = vb[j++];
+
+    IntContainer c = { a->key, INT_CONTAINER_ARRAY, k, k, a->n + b->n, out };
+    return c;
+}
+
+static IntContainer r_combine(const IntContainer* a, const IntContainer* b, IntSetOp op)
+{
+    // sparse operands are cheaper to test value by value than to expand
+    if (op != INT_SET_OR && a->kind == INT_CONTAINER_ARRAY)
+        return r_filter(a, b, op == INT_SET_AND);
+    if (op == INT_SET_AND && b->kind == INT_CONTAINER_ARRAY)
+        return r_filter(b, a, true);
+    if (op == INT_SET_OR && a->kind == INT_CONTAINER_ARRAY && b->kind == INT_CONTAINER_ARRAY &&
+        a->n + b->n <= INT_SET_ARRAY_MAX)
+        return r_merge(a, b);
+
+    uint64_t* words = malloc(sizeof(uint64_t) * INT_SET_WORDS);
+    assert(words != NULL);
+    uint64_t other[INT_SET_WORDS];
+
+    r_words(a, words);
+    r_words(b, other);
+
+    uint32_t cardinality = 0;
+    for (uint32_t i = 0; i < INT_SET_WORDS; i++)
+    {
+        if (op == INT_SET_OR)
+            words[i] |= other[i];
+        else if (op == INT_SET_AND)
+            words[i] &= other[i];
+        else
+            words[i] &= ~other[i];
+
+        cardinality += r_popcount(words[i]);
+    }
+
+    return r_pack(a->key, words, cardinality);
+}
+
+// set level
+
+// index of the container for key, or where it would be inserted
+static size_t r_find(const IntSet* set, uint16_t key, bool* found)
+{
+    size_t lo = 0, hi = set->_count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (set->_containers[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    *found = lo < set->_count && set->_containers[lo].key == key;
+    return lo;
+}
+
+static void r_insert_container(IntSet* set, size_t index, IntContainer c)
+{
+    if (set->_count >= set->_capacity)
+    {
+        set->_capacity = (set->_capacity > 0) ? set->_capacity * 2 : 4;
+
+        IntContainer* tmp = realloc(set->_containers, sizeof(IntContainer) * set->_capacity);
+        assert(tmp != NULL);
+        set->_containers = tmp;
+    }
+
+    memmove(&set->_containers[index + 1], &set->_containers[index],
+            sizeof(IntContainer) * (set->_count - index));
+    set->_containers[index] = c;
+    set->_count++;
+    set->_elements += c.cardinality;
+}
+
+static void r_append(IntSet* set, IntContainer c)
+{
+    if (c.cardinality == 0)
+    {
+        free(c.data);
+        return;
+    }
+
+    r_insert_container(set, set->_count, c);
+}
+
+static void r_remove_container(IntSet* set, size_t index)
+{
+    set->_elements -= set->_containers[index].cardinality;
+    free(set->_containers[index].data);
+
+    memmove(&set->_containers[index], &set->_containers[index + 1],
+            sizeof(IntContainer) * (set->_count - index - 1));
+    set->_count--;
+}
+
+void int_set_insert(IntSet* set, uint32_t value)
+{
+    uint16_t key = (uint16_t)(value >> 16);
+    uint16_t low = (uint16_t)value;
+
+    bool found;
+    size_t index = r_find(set, key, &found);
+
+    if (!found)
+    {
+        IntContainer empty = { key, INT_CONTAINER_ARRAY, 0, 0, 0, NULL };
+        r_insert_container(set, index, empty);
+    }
+
+    IntContainer* c = &set->_containers[index];
+    r_materialize(c);
+
+    if (c->kind == INT_CONTAINER_ARRAY)
+    {
+        uint16_t* values = c->data;
+        uint32_t pos = r_lower_bound(values, c->n, low);
+
+        if (pos < c->n && values[pos] == low)
+            return;
+
+        if (c->n >= INT_SET_ARRAY_MAX)
+            r_to_bitmap(c);
+        else
+        {
+            if (c->n >= c->capacity)
+            {
+                c->capacity = (c->capacity > 0) ? c->capacity * 2 : 4;
+                if (c->capacity > INT_SET_ARRAY_MAX)
+                    c->capacity = INT_SET_ARRAY_MAX;
+
+                values = realloc(c->data, sizeof(uint16_t) * c->capacity);
+                assert(values != NULL);
+                c->data = values;
+            }
+
+            memmove(&values[pos + 1], &values[pos], sizeof(uint16_t) * (c->n - pos));
+            values[pos] = low;
+            c->n++;
+            c->cardinality++;
+            set->_elements++;
+            return;
+        }
+    }
+
+    uint64_t* words = c->data;
+    uint64_t bit = 1ULL << (low & 63);
+
+    if (words[low >> 6] & bit)
+        return;
+
+    words[low >> 6] |= bit;
+    c->cardinality++;
+    set->_elements++;
+}
+
+void int_set_erase(IntSet* set, uint32_t value)
+{
+    uint16_t key = (uint16_t)(value >> 16);
+    uint16_t low = (uint16_t)value;
+
+    bool found;
+    size_t index = r_find(set, key, &found);
+
+    if (!found)
+        return;
+
+    IntContainer* c = &set->_containers[index];
+    r_materialize(c);
+
+    if (c->kind == INT_CONTAINER_ARRAY)
+    {
+        uint16_t* values = c->data;
+        uint32_t pos = r_lower_bound(values, c->n, low);
+
+        if (pos >= c->n || values[pos] != low)
+            return;
+
+        memmove(&values[pos], &values[pos + 1], sizeof(uint16_t) * (c->n - pos - 1));
+        c->n--;
+    }
+    else
+    {
+        uint64_t* words = c->data;
+        uint64_t bit = 1ULL << (low & 63);
+
+        if (!(words[low >> 6] & bit))
+            return;
+
+        words[low >> 6] &= ~bit;
+    }
+
+    c->cardinality--;
+    set->_elements--;
+
+    if (c->cardinality == 0)
+        r_remove_container(set, index);
+    else if (c->kind == INT_CONTAINER_BITMAP && c->cardinality <= INT_SET_ARRAY_MAX)
+        r_to_array(c);
+}
+
+bool int_set_contains(IntSet* set, uint32_t value)
+{
+    bool found;
+    size_t index = r_find(set, (uint16_t)(value >> 16), &found);
+
+    return found && r_container_contains(&set->_containers[index], (uint16_t)value);
+}
+
+bool int_set_empty(IntSet* set)
+{
+    return (set->_elements == 0);
+}
+
+size_t int_set_size(IntSet* set)
+{
+    return set->_elements;
+}
+
+void int_set_clear(IntSet* set)
+{
+    for (size_t i = 0; i < set->_count; i++)
+        free(set->_containers[i].data);
+
+    free(set->_containers);
+    set->_containers = NULL;
+    set->_count = 0;
+    set->_capacity = 0;
+    set->_elements = 0;
+}
+
+void int_set_optimize(IntSet* set)
+{
+    uint16_t* values = malloc(sizeof(uint16_t) * 65536);
+    assert(values != NULL);
+
+    for (size_t i = 0; i < set->_count; i++)
+    {
+        IntContainer* c = &set->_containers[i];
+        if (c->kind == INT_CONTAINER_RUN)
+            continue;
+
+        uint32_t n = r_extract(c, values);
+
+        uint32_t runs = 1;
+        for (uint32_t j = 1; j < n; j++)
+        {
+            if (values[j] != values[j - 1] + 1)
+                runs++;
+        }
+
+        size_t current = (c->kind == INT_CONTAINER_ARRAY) ?
+            sizeof(uint16_t) * n : sizeof(uint64_t) * INT_SET_WORDS;
+
+        if (sizeof(IntRun) * runs >= current)
+            continue;
+
+        IntRun* out = malloc(sizeof(IntRun) * runs);
+        assert(out != NULL);
+
+        uint32_t k = 0;
+        out[0].start = values[0];
+        out[0].length = 0;
+        for (uint32_t j = 1; j < n; j++)
+        {
+            if (values[j] == values[j - 1] + 1)
+                out[k].length++;
+            else
+            {
+                k++;
+                out[k].start = values[j];
+                out[k].length = 0;
+            }
+        }
+
+        free(c->data);
+        c->data = out;
+        c->kind = INT_CONTAINER_RUN;
+        c->n = runs;
+        c->capacity = runs;
+    }
+
+    free(values);
+}
+
+size_t int_set_to_array(IntSet* set, uint32_t* out)
+{
+    uint16_t* values = malloc(sizeof(uint16_t) * 65536);
+    assert(values != NULL);
+
+    size_t k = 0;
+    for (size_t i = 0; i < set->_count; i++)
+    {
+        uint32_t base = (uint32_t)set->_containers[i].key << 16;
+        uint32_t n = r_extract(&set->_containers[i], values);
+
+        for (uint32_t j = 0; j < n; j++)
+            out[k++] = base | values[j];
+    }
+
+    free(values);
+    return k;
+}
+
+IntSet int_set_union(IntSet* a, IntSet* b)
+{
+    IntSet c = constructor_int_set();
+
+    size_t i = 0, j = 0;
+    while (i < a->_count || j < b->_count)
+    {
+        if (j >= b->_count || (i < a->_count && a->_containers[i].key < b->_containers[j].key))
+            r_append(&c, r_clone(&a->_containers[i++]));
+        else if (i >= a->_count || b->_containers[j].key < a->_containers[i].key)
+            r_append(&c, r_clone(&b->_containers[j++]));
+        else
+            r_append(&c, r_combine(&a->_containers[i++], &b->_containers[j++], INT_SET_OR));
+    }
+
+    return c;
+}
+
+IntSet int_set_intersection(IntSet* a, IntSet* b)
+{
+    IntSet c = constructor_int_set();
+
+    size_t i = 0, j = 0;
+    while (i < a->_count && j < b->_count)
+    {
+        if (a->_containers[i].key < b->_containers[j].key)
+            i++;
+        else if (b->_containers[j].key < a->_containers[i].key)
+            j++;
+        else
+            r_append(&c, r_combine(&a->_containers[i++], &b->_containers[j++], INT_SET_AND));
+    }
+
+    return c;
+}
+
+IntSet int_set_difference(IntSet* a, IntSet* b)
+{
+    IntSet c = constructor_int_set();
+
+    size_t i = 0, j = 0;
+    while (i < a->_count)
+    {
+        if (j >= b->_count || a->_containers[i].key < b->_containers[j].key)
+            r_append(&c, r_clone(&a->_containers[i++]));
+        else if (b->_containers[j].key < a->_containers[i].key)
+            j++;
+        else
+            r_append(&c, r_combine(&a->_containers[i++], &b->_containers[j++], INT_SET_ANDNOT));
+    }
+
+    return c;
+}
+
+bool int_set_is_subset(IntSet* a, IntSet* b)
+{
+    if (a->_elements > b->_elements)
+        return false;
+
+    for (size_t i = 0; i < a->_count; i++)
+    {
+        bool found;
+        size_t index = r_find(b, a->_containers[i].key, &found);
+
+        if (!found)
+            return false;
+
+        IntContainer rest = r_combine(&a->_containers[i], &b->_containers[index], INT_SET_ANDNOT);
+        free(rest.data);
+
+        if (rest.cardinality > 0)
+            return false;
+    }
+
+    return true;
+}
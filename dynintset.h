@@ -0,0 +1,125 @@
+// Compressed integer set in C in the style of Roaring bitmaps, companion to the SET container
+
+/*  HOW TO USE:
+
+    Call constructor_int_set() to define attributes and function pointers.
+    Call destructor_int_set(set) in order to clean up.
+    If set goes out of scope without destructor being called, a memory leak will occur.
+    Build dynintset.c with the program, or link the dyncontainers library.
+
+    Values are 32-bit unsigned integers. They are split on their high 16 bits into
+    chunks of 65536, and each non-empty chunk is stored in whichever container suits it:
+        array  - sorted 16-bit values, while the chunk holds at most INT_SET_ARRAY_MAX values
+        bitmap - 1024 64-bit words, once the chunk becomes denser than that
+        run    - (start, length) pairs, produced by optimize() when they are smaller still
+    Union, intersection and difference work chunk by chunk, a word at a time.
+
+    example:
+
+    int main(void)
+    {
+        IntSet a = constructor_int_set();
+        IntSet b = constructor_int_set();
+
+        for (uint32_t i = 0; i < 100000; i++)
+            a.insert(&a, i);
+        b.insert(&b, 5);
+        b.insert(&b, 200000);
+
+        IntSet c = int_set_intersection(&a, &b);    // { 5 }
+
+        destructor_int_set(a);
+        destructor_int_set(b);
+        destructor_int_set(c);
+
+        return 0;
+    }
+
+    Do not manually modify: _containers, _count, _capacity or _elements.
+    Use function pointers to do so.
+
+*/
+
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#define INT_SET_ARRAY_MAX 4096
+#define INT_SET_WORDS 1024
+
+#define constructor_int_set()                                               \
+{                                                                           \
+    ._containers = NULL, ._count = 0, ._capacity = 0, ._elements = 0,       \
+    .insert = int_set_insert, .erase = int_set_erase,                       \
+    .contains = int_set_contains, .empty = int_set_empty,                   \
+    .size = int_set_size, .clear = int_set_clear,                           \
+    .optimize = int_set_optimize, .to_array = int_set_to_array              \
+}
+
+#define destructor_int_set(item) \
+    item.clear(&item)
+
+typedef enum IntContainerKind
+{
+    INT_CONTAINER_ARRAY,
+    INT_CONTAINER_BITMAP,
+    INT_CONTAINER_RUN
+} IntContainerKind;
+
+// covers start through start + length inclusive
+typedef struct IntRun
+{
+    uint16_t start;
+    uint16_t length;
+} IntRun;
+
+typedef struct IntContainer
+{
+    uint16_t key;
+    IntContainerKind kind;
+    uint32_t cardinality;
+    uint32_t n;         // values held (array) or runs held (run)
+    uint32_t capacity;  // allocated slots for the above
+    void* data;         // uint16_t[] | uint64_t[INT_SET_WORDS] | IntRun[]
+} IntContainer;
+
+typedef struct IntSet
+{
+    IntContainer* _containers;
+    size_t _count;
+    size_t _capacity;
+    size_t _elements;
+
+    void (*insert)(struct IntSet*, uint32_t);
+    void (*erase)(struct IntSet*, uint32_t);
+    bool (*contains)(struct IntSet*, uint32_t);
+    bool (*empty)(struct IntSet*);
+    size_t (*size)(struct IntSet*);
+    void (*clear)(struct IntSet*);
+    void (*optimize)(struct IntSet*);
+    size_t (*to_array)(struct IntSet*, uint32_t*);
+} IntSet;
+
+void int_set_insert(IntSet* set, uint32_t value);
+void int_set_erase(IntSet* set, uint32_t value);
+bool int_set_contains(IntSet* set, uint32_t value);
+bool int_set_empty(IntSet* set);
+size_t int_set_size(IntSet* set);
+void int_set_clear(IntSet* set);
+
+// converts every container whose values form few enough runs into a run container
+void int_set_optimize(IntSet* set);
+// out must have room for size() values, which are written in ascending order
+size_t int_set_to_array(IntSet* set, uint32_t* out);
+
+IntSet int_set_union(IntSet* a, IntSet* b);
+IntSet int_set_intersection(IntSet* a, IntSet* b);
+// values of a that are not in b
+IntSet int_set_difference(IntSet* a, IntSet* b);
+// true when every value of a is also in b
+bool int_set_is_subset(IntSet* a, IntSet* b);
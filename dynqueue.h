@@ -9,6 +9,8 @@
     Call destructor(que) in order to clean up.
     If queue goes out of scope without destructor being called, a memory leak will occur.
 
+    To use one instantiation from several files see DECLARE_QUEUE in README.
+
     example:
 
     QUEUE(int)
@@ -62,9 +64,14 @@
         item._type_size = 0
 #endif 
 
-#define QUEUE(type) typedef struct queue_##type                             \
+#define QUEUE(type)                                                         \
+    DECLARE_QUEUE(type)                                                     \
+    DEFINE_QUEUE(type)
+
+#define DECLARE_QUEUE(type)                                                 \
+typedef struct queue_##type                                                 \
 {                                                                           \
-    type*  _array;                                                           \
+    type*  _array;                                                          \
     size_t _elements;                                                       \
     size_t _capacity;                                                       \
     size_t _type_size;                                                      \
@@ -76,6 +83,14 @@
     size_t (*size)(struct queue_##type*);                                   \
 } queue_##type;                                                             \
                                                                             \
+void   queue_push_##type(struct queue_##type*, type);                       \
+void   queue_pop_##type(struct queue_##type*);                              \
+type   queue_front_##type(struct queue_##type*);                            \
+type   queue_back_##type(struct queue_##type*);                             \
+bool   queue_empty_##type(struct queue_##type*);                            \
+size_t queue_size_##type(struct queue_##type*);
+
+#define DEFINE_QUEUE(type)                                                  \
 void queue_push_##type(struct queue_##type* que, type elem)                 \
 {                                                                           \
     if (que->_elements >= que->_capacity)                                   \
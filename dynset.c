@@ -0,0 +1,15 @@
+#include "dynset.h"
+
+unsigned long djb2(const unsigned char *str, size_t len)
+{
+    unsigned long hash = 5381;
+
+    for (int i = 0; i < len; i++)
+        hash = ((hash << 5) + hash) + str[i];
+
+    return hash;
+}
+unsigned int get_index(unsigned long hash, size_t capacity)
+{
+    return hash % capacity;
+}
@@ -17,6 +17,8 @@
     .begin = begin_##type, .next = next_##type, .end = end_##type,          \
     .insert = insert_##type, .erase = erase_##type, .clear = clear_##type,  \
     .contains = contains_##type, .empty = empty_##type,                     \
+    .insert_batch = insert_batch_##type,                                    \
+    .contains_batch = contains_batch_##type,                                \
     .size = size_##type, .capacity = capacity_##type                        \
 }
 
@@ -25,55 +27,34 @@
 
 // slightly modified version of djb2 algorithm to allow handling of null terminators (e.g. hash an int 0)
 // there are other ways to accomplish this (e.g. snprintf) but this method is simple and general purpose
-unsigned long djb2(const unsigned char *str, size_t len)
-{
-    unsigned long hash = 5381;
+unsigned long djb2(const unsigned char *str, size_t len);
+unsigned int get_index(unsigned long hash, size_t capacity);
 
-    for (int i = 0; i < len; i++)
-        hash = ((hash << 5) + hash) + str[i];
+// batched operations hash SET_BATCH keys and prefetch their home buckets
+// before probing any of them, so the cache misses overlap instead of queueing
+// contains_batch sets bit i (low bit first) of found when values[i] is in the set,
+// found must hold (n + 7) / 8 bytes
+#define SET_BATCH 16
 
-    return hash;
-}
-unsigned int get_index(unsigned long hash, size_t capacity)
-{
-    return hash % capacity;
-}
+#if defined(__GNUC__) || defined(__clang__)
+    #define set_prefetch(addr) __builtin_prefetch(addr)
+#else
+    #define set_prefetch(addr) ((void)(addr))
+#endif
 
 // the _cmp and _hash function pointers are plug-n-play
 // for structs or other complex comparisons/hashes
 // they can be substituted with custom functions
 // plug-n-play functions <--> can be swapped out for custom functions if needed
 
+// to use one instantiation from several files see DECLARE_SET in README
+// djb2 and get_index live in dynset.c, so link it or the dyncontainers library
+
 #define SET(type)                                                                            \
-                                                                                             \
-bool compare_general_##type(type a, type b)                                                  \
-{                                                                                            \
-    return a == b;                                                                           \
-}                                                                                            \
-                                                                                             \
-bool compare_string_##type(const char* a, const char* b)                                     \
-{                                                                                            \
-    return !strcmp(a, b);                                                                    \
-}                                                                                            \
-                                                                                             \
-unsigned long hash_general_##type(type item)                                                 \
-{                                                                                            \
-    size_t len = sizeof(item);                                                               \
-    unsigned char data[len];                                                                 \
-    memcpy(data, &item, len);                                                                \
-                                                                                             \
-    return djb2(data, len);                                                                  \
-}                                                                                            \
-                                                                                             \
-unsigned long hash_string_##type(const char* item)                                           \
-{                                                                                            \
-    size_t len = strlen(item);                                                               \
-    unsigned char data[len];                                                                 \
-    memcpy(data, &item, len);                                                                \
-                                                                                             \
-    return djb2(data, len);                                                                  \
-}                                                                                            \
-                                                                                             \
+    DECLARE_SET(type)                                                                        \
+    DEFINE_SET(type)
+
+#define DECLARE_SET(type)                                                                    \
 typedef struct SetBucket_##type                                                              \
 {                                                                                            \
     unsigned long hash;                                                                      \
@@ -91,20 +72,71 @@ typedef struct Set_##type
     bool (*_cmp)(type, type);                                                                \
     unsigned long (*_hash)(type);                                                            \
                                                                                              \
-    SetIter_##type *(*begin)(struct Set_int*);                                               \
-    SetIter_##type *(*next)(struct Set_int*, SetIter_##type*);                               \
-    SetIter_##type *(*end)(struct Set_int*);                                                 \
+    SetIter_##type *(*begin)(struct Set_##type*);                                            \
+    SetIter_##type *(*next)(struct Set_##type*, SetIter_##type*);                            \
+    SetIter_##type *(*end)(struct Set_##type*);                                              \
                                                                                              \
     void (*insert)(struct Set_##type*, type);                                                \
     void (*erase)(struct Set_##type*, type);                                                 \
     bool (*contains)(struct Set_##type*, type);                                              \
+    void (*insert_batch)(struct Set_##type*, type*, size_t);                                 \
+    void (*contains_batch)(struct Set_##type*, type*, size_t, unsigned char*);               \
     bool (*empty)(struct Set_##type*);                                                       \
     size_t (*size)(struct Set_##type*);                                                      \
     size_t (*capacity)(struct Set_##type*);                                                  \
     void (*clear)(struct Set_##type*);                                                       \
 } Set_##type;                                                                                \
                                                                                              \
-SetIter_##type *begin_int(Set_##type* set)                                                   \
+bool compare_general_##type(type, type);                                                     \
+bool compare_string_##type(const char*, const char*);                                        \
+unsigned long hash_general_##type(type);                                                     \
+unsigned long hash_string_##type(const char*);                                               \
+                                                                                             \
+SetIter_##type *begin_##type(Set_##type*);                                                   \
+SetIter_##type *next_##type(Set_##type*, SetIter_##type*);                                   \
+SetIter_##type *end_##type(Set_##type*);                                                     \
+                                                                                             \
+void insert_##type(Set_##type*, type);                                                       \
+void erase_##type(Set_##type*, type);                                                        \
+void clear_##type(Set_##type*);                                                              \
+bool contains_##type(Set_##type*, type);                                                     \
+void insert_batch_##type(Set_##type*, type*, size_t);                                        \
+void contains_batch_##type(Set_##type*, type*, size_t, unsigned char*);                      \
+bool empty_##type(Set_##type*);                                                              \
+size_t size_##type(Set_##type*);                                                             \
+size_t capacity_##type(Set_##type*);                                                         \
+                                                                                             \
+bool set_is_subset_##type(Set_##type*, Set_##type*);                                         \
+Set_##type set_union_##type(Set_##type*, Set_##type*);                                       \
+Set_##type set_difference_##type(Set_##type*, Set_##type*);                                  \
+Set_##type set_intersection_##type(Set_##type*, Set_##type*);
+
+#define DEFINE_SET(type)                                                                     \
+bool compare_general_##type(type a, type b)                                                  \
+{                                                                                            \
+    return a == b;                                                                           \
+}                                                                                            \
+                                                                                             \
+bool compare_string_##type(const char* a, const char* b)                                     \
+{                                                                                            \
+    return !strcmp(a, b);                                                                    \
+}                                                                                            \
+                                                                                             \
+unsigned long hash_general_##type(type item)                                                 \
+{                                                                                            \
+    size_t len = sizeof(item);                                                               \
+    unsigned char data[len];                                                                 \
+    memcpy(data, &item, len);                                                                \
+                                                                                             \
+    return djb2(data, len);                                                                  \
+}                                                                                            \
+                                                                                             \
+unsigned long hash_string_##type(const char* item)                                           \
+{                                                                                            \
+    return djb2((const unsigned char*)item, strlen(item));                                   \
+}                                                                                            \
+                                                                                             \
+SetIter_##type *begin_##type(Set_##type* set)                                                \
 {                                                                                            \
     SetIter_##type *iter = set->_array;                                                      \
     while (                                                                                  \
@@ -113,7 +145,7 @@ SetIter_##type *begin_int(Set_##type* set)
     return iter;                                                                             \
 }                                                                                            \
                                                                                              \
-SetIter_##type *next_int(Set_##type* set, SetIter_##type* iter)                              \
+SetIter_##type *next_##type(Set_##type* set, SetIter_##type* iter)                           \
 {                                                                                            \
     do {                                                                                     \
         ++iter;                                                                              \
@@ -123,29 +155,27 @@ SetIter_##type *next_int(Set_##type* set, SetIter_##type* iter)
     return iter;                                                                             \
 }                                                                                            \
                                                                                              \
-SetIter_##type *end_int(Set_int* set)                                                        \
+SetIter_##type *end_##type(Set_##type* set)                                                  \
 {                                                                                            \
     return set->_array + set->_capacity;                                                     \
 }                                                                                            \
                                                                                              \
 unsigned int                                                                                 \
-h_lprobe_##type(Set_##type *set, int value, unsigned int index, bool skip_tombstones)        \
+h_lprobe_##type(Set_##type *set, type value, unsigned int index, bool skip_tombstones)       \
 {                                                                                            \
     assert(set && set->_array);                                                              \
                                                                                              \
     unsigned int found = -1;                                                                 \
-    unsigned int tombstone = -1;                                                             \
     unsigned int count = 1;                                                                  \
                                                                                              \
+    /* never writes to the table, so lookups are safe on a set shared between readers */     \
     while (found == -1)                                                                      \
     {                                                                                        \
         SetBucket_##type bucket = set->_array[index];                                        \
                                                                                              \
-        if (skip_tombstones && tombstone == -1 &&                                            \
-            bucket.hash != -1 && bucket.tombstone)                                           \
-            tombstone = index;                                                               \
-        else if (set->_cmp(bucket.value, value) || (!skip_tombstones &&                      \
-            (bucket.hash == -1 || bucket.tombstone)))                                        \
+        if (bucket.hash != -1 && !bucket.tombstone && set->_cmp(bucket.value, value))        \
+            found = index;                                                                   \
+        else if (!skip_tombstones && (bucket.hash == -1 || bucket.tombstone))                \
             found = index;                                                                   \
         else if (skip_tombstones && bucket.hash == -1)                                       \
             break;                                                                           \
@@ -156,16 +186,6 @@ h_lprobe_##type(Set_##type *set, int value, unsigned int index, bool skip_tombst
             break;                                                                           \
     }                                                                                        \
                                                                                              \
-    if (tombstone != -1 && found != -1)                                                      \
-    {                                                                                        \
-        set->_array[tombstone].value = set->_array[found].value;                             \
-        set->_array[tombstone].tombstone = false;                                            \
-        set->_array[found].value = -1;                                                       \
-        set->_array[found].tombstone = true;                                                 \
-                                                                                             \
-        found = tombstone;                                                                   \
-    }                                                                                        \
-                                                                                             \
     return found;                                                                            \
 }                                                                                            \
                                                                                              \
@@ -201,15 +221,33 @@ void h_resize_##type(Set_##type *set, float factor)
     free(tmp);                                                                               \
 }                                                                                            \
                                                                                              \
+void h_place_##type(Set_##type *set, type value, unsigned long hash, unsigned int index)     \
+{                                                                                            \
+    assert(set->_array);                                                                     \
+                                                                                             \
+    /* look past tombstones first, the value may sit further down the chain */               \
+    if (h_lprobe_##type(set, value, index, true) != (unsigned int)-1)                        \
+        return;                                                                              \
+                                                                                             \
+    index = h_lprobe_##type(set, value, index, false);                                       \
+                                                                                             \
+    SetBucket_##type bucket = { hash, value, false };                                        \
+    set->_array[index] = bucket;                                                             \
+    set->_elements++;                                                                        \
+}                                                                                            \
+                                                                                             \
+void h_init_##type(Set_##type *set)                                                          \
+{                                                                                            \
+    set->_capacity = 8;                                                                      \
+    free(set->_array);                                                                       \
+    set->_array = malloc(set->_type_size * set->_capacity);                                  \
+    memset(set->_array, -1, set->_type_size * set->_capacity);                               \
+}                                                                                            \
+                                                                                             \
 void insert_##type(Set_##type* set, type value)                                              \
 {                                                                                            \
     if (set->_elements == 0)                                                                 \
-    {                                                                                        \
-        set->_capacity = 8;                                                                  \
-        free(set->_array);                                                                   \
-        set->_array = malloc(set->_type_size * set->_capacity);                              \
-        memset(set->_array, -1, set->_type_size * set->_capacity);                           \
-    }                                                                                        \
+        h_init_##type(set);                                                                  \
     else                                                                                     \
     {                                                                                        \
         float load_factor = ((float)set->_elements / (float)set->_capacity);                 \
@@ -220,14 +258,35 @@ void insert_##type(Set_##type* set, type value)
     unsigned long hash = set->_hash(value);                                                  \
     unsigned int index = get_index(hash, set->_capacity);                                    \
                                                                                              \
-    assert(set->_array);                                                                     \
-    index = h_lprobe_##type(set, value, index, false);                                       \
+    h_place_##type(set, value, hash, index);                                                 \
+}                                                                                            \
                                                                                              \
-    if (set->_array[index].value != value)                                                   \
-        set->_elements++;                                                                    \
+void insert_batch_##type(Set_##type* set, type* values, size_t n)                            \
+{                                                                                            \
+    unsigned long hash[SET_BATCH];                                                           \
+    unsigned int index[SET_BATCH];                                                           \
                                                                                              \
-    SetBucket_##type bucket = { hash, value, false };                                        \
-    set->_array[index] = bucket;                                                             \
+    for (size_t base = 0; base < n; base += SET_BATCH)                                       \
+    {                                                                                        \
+        size_t count = (n - base < SET_BATCH) ? n - base : SET_BATCH;                        \
+                                                                                             \
+        if (set->_elements == 0)                                                             \
+            h_init_##type(set);                                                              \
+                                                                                             \
+        /* grow up front so no resize happens between prefetch and probe */                  \
+        while ((float)(set->_elements + count) / (float)set->_capacity >= 0.75f)             \
+            h_resize_##type(set, 2.f);                                                       \
+                                                                                             \
+        for (size_t i = 0; i < count; i++)                                                   \
+        {                                                                                    \
+            hash[i] = set->_hash(values[base + i]);                                          \
+            index[i] = get_index(hash[i], set->_capacity);                                   \
+            set_prefetch(&set->_array[index[i]]);                                            \
+        }                                                                                    \
+                                                                                             \
+        for (size_t i = 0; i < count; i++)                                                   \
+            h_place_##type(set, values[base + i], hash[i], index[i]);                        \
+    }                                                                                        \
 }                                                                                            \
                                                                                              \
 void erase_##type(Set_##type* set, type value)                                               \
@@ -243,6 +302,20 @@ void erase_##type(Set_##type* set, type value)
         set->_array[index].value = -1;                                                       \
         set->_array[index].tombstone = true;                                                 \
         set->_elements--;                                                                    \
+                                                                                             \
+        /* probes stop at an empty bucket anyway, so tombstones directly before one */       \
+        /* can be emptied; this keeps probe chains short without lookups writing */          \
+        unsigned int next = (index + 1) % set->_capacity;                                    \
+        for (size_t count = 0; count < set->_capacity; count++)                              \
+        {                                                                                    \
+            SetBucket_##type* bucket = &set->_array[index];                                  \
+            if (set->_array[next].hash != -1 || bucket->hash == -1 || !bucket->tombstone)    \
+                break;                                                                       \
+                                                                                             \
+            memset(bucket, -1, sizeof(SetBucket_##type));                                    \
+            next = index;                                                                    \
+            index = (index + set->_capacity - 1) % set->_capacity;                           \
+        }                                                                                    \
     }                                                                                        \
                                                                                              \
     float load_factor = ((float)set->_elements / (float)set->_capacity);                     \
@@ -268,6 +341,34 @@ bool contains_##type(Set_##type* set, type value)
                                                                                              \
     index = h_lprobe_##type(set, value, index, true);                                        \
     return index != -1;                                                                      \
+}                                                                                            \
+                                                                                             \
+                                                                                             \
+void contains_batch_##type(Set_##type* set, type* values, size_t n, unsigned char* found)    \
+{                                                                                            \
+    unsigned int index[SET_BATCH];                                                           \
+                                                                                             \
+    memset(found, 0, (n + 7) / 8);                                                           \
+    if (set->_elements < 1)                                                                  \
+        return;                                                                              \
+                                                                                             \
+    for (size_t base = 0; base < n; base += SET_BATCH)                                       \
+    {                                                                                        \
+        size_t count = (n - base < SET_BATCH) ? n - base : SET_BATCH;                        \
+                                                                                             \
+        for (size_t i = 0; i < count; i++)                                                   \
+        {                                                                                    \
+            index[i] = get_index(set->_hash(values[base + i]), set->_capacity);              \
+            set_prefetch(&set->_array[index[i]]);                                            \
+        }                                                                                    \
+                                                                                             \
+        for (size_t i = 0; i < count; i++)                                                   \
+        {                                                                                    \
+            if (h_lprobe_##type(set, values[base + i], index[i], true) !=                    \
+                (unsigned int)-1)                                                            \
+                found[(base + i) / 8] |= (unsigned char)(1u << ((base + i) % 8));            \
+        }                                                                                    \
+    }                                                                                        \
 }                                                                                            \
                                                                                              \
 bool empty_##type(Set_##type* set)                                                           \
@@ -0,0 +1,275 @@
+// Read-mostly snapshot (RCU style) wrapper in C for publishing immutable containers
+
+// TODO: test
+
+/*  HOW TO USE:
+
+    Call SNAPSHOT(type) with a container type, e.g. SNAPSHOT(array_int) or SNAPSHOT(Set_int).
+    Call constructor_snapshot(type, release, max_readers) to define attributes and function
+    pointers, where release(type*) frees a heap allocated container and everything it owns
+    and max_readers is how many reader threads may be attached at the same time.
+    Call destructor_snapshot(snap) in order to clean up, once no reader is active.
+    If snapshot goes out of scope without destructor being called, a memory leak will occur.
+
+    To use one instantiation from several files see DECLARE_SNAPSHOT in README.
+
+    The writer builds a whole new container on the heap and publishes it; the previous
+    one is retired and released once no reader can still be looking at it. Only one
+    thread may publish at a time.
+
+    Each reader thread attaches once to get a slot of its own; the constructor allocates
+    max_readers slots of one cache line each. Between enter and leave the returned
+    container stays valid and must be treated as read-only. Readers take no lock and
+    write only to their own cache line, so read cost does not grow with the number of
+    readers. Retirement is epoch based: a container replaced during epoch e is released
+    when every reader inside a read section entered after e.
+
+    When all max_readers slots are taken, attach returns SNAPSHOT_NO_READER. enter then
+    returns NULL and leave and detach do nothing, in release builds too, so check the
+    result of attach.
+
+    Readers may only call functions that do not write to the container:
+        ARRAY - get, front, back, size, empty
+        SET   - begin, next, end, contains, contains_batch, size
+    SET lookups never move buckets, tombstones are cleaned up by erase instead.
+
+    example:
+
+    ARRAY(int)
+    SNAPSHOT(array_int)
+
+    void release_array(array_int* arr)
+    {
+        free(arr->_array);
+        free(arr);
+    }
+
+    int main(void)
+    {
+        snapshot_array_int table = constructor_snapshot(array_int, release_array, 8);
+
+        array_int* next = malloc(sizeof(array_int));        // writer thread
+        *next = (array_int)constructor_array(int);
+        next->push_back(next, 42);
+        table.publish(&table, next);
+
+        int reader = table.attach(&table);                  // each reader thread, once
+        if (reader == SNAPSHOT_NO_READER)
+            return 1;
+        array_int* arr = table.enter(&table, reader);
+        printf("%d\n", arr->get(arr, 0));
+        table.leave(&table, reader);
+        table.detach(&table, reader);
+
+        destructor_snapshot(table);
+
+        return 0;
+    }
+
+    Do not manually modify: _current, _epoch, _slots, _max_readers or _retired.
+    Use function pointers to do so.
+
+*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <stdatomic.h>
+
+#define SNAPSHOT_NO_READER (-1)
+#define SNAPSHOT_CACHE_LINE 64
+
+#define constructor_snapshot(type, release, max_readers)                      \
+{                                                                             \
+    ._current = NULL, ._epoch = 1, ._release = release,                       \
+    ._slots = snapshot_slots_##type(max_readers),                             \
+    ._max_readers = max_readers,                                              \
+    ._retired = NULL, ._retired_count = 0, ._retired_capacity = 0,            \
+    .attach = snapshot_attach_##type, .detach = snapshot_detach_##type,       \
+    .enter = snapshot_enter_##type, .leave = snapshot_leave_##type,           \
+    .publish = snapshot_publish_##type, .reclaim = snapshot_reclaim_##type,   \
+    .clear = snapshot_clear_##type                                            \
+}
+
+#define destructor_snapshot(item) \
+    item.clear(&item)
+
+// one per reader, padded so a reader's writes never share a line with anyone else's
+// the array of them is allocated line aligned by the constructor
+// epoch is 0 while the reader is outside a read section
+typedef struct SnapshotSlot
+{
+    _Alignas(SNAPSHOT_CACHE_LINE) atomic_ulong epoch;
+    atomic_bool in_use;
+} SnapshotSlot;
+
+#define SNAPSHOT(type)                                                                  \
+    DECLARE_SNAPSHOT(type)                                                              \
+    DEFINE_SNAPSHOT(type)
+
+#define DECLARE_SNAPSHOT(type)                                                          \
+typedef struct snapshot_retired_##type                                                  \
+{                                                                                       \
+    type* item;                                                                         \
+    unsigned long epoch;                                                                \
+} snapshot_retired_##type;                                                              \
+                                                                                        \
+typedef struct snapshot_##type                                                          \
+{                                                                                       \
+    _Alignas(SNAPSHOT_CACHE_LINE) _Atomic(type*) _current;                              \
+    atomic_ulong _epoch;                                                                \
+    SnapshotSlot* _slots;                                                               \
+    int _max_readers;                                                                   \
+                                                                                        \
+    void (*_release)(type*);                                                            \
+    snapshot_retired_##type* _retired;                                                  \
+    size_t _retired_count;                                                              \
+    size_t _retired_capacity;                                                           \
+                                                                                        \
+    int    (*attach)(struct snapshot_##type*);                                          \
+    void   (*detach)(struct snapshot_##type*, int);                                     \
+    type*  (*enter)(struct snapshot_##type*, int);                                      \
+    void   (*leave)(struct snapshot_##type*, int);                                      \
+    void   (*publish)(struct snapshot_##type*, type*);                                  \
+    void   (*reclaim)(struct snapshot_##type*);                                         \
+    void   (*clear)(struct snapshot_##type*);                                           \
+} snapshot_##type;                                                                      \
+                                                                                        \
+SnapshotSlot* snapshot_slots_##type(int);                                               \
+int    snapshot_attach_##type(struct snapshot_##type*);                                 \
+void   snapshot_detach_##type(struct snapshot_##type*, int);                            \
+type*  snapshot_enter_##type(struct snapshot_##type*, int);                             \
+void   snapshot_leave_##type(struct snapshot_##type*, int);                             \
+void   snapshot_publish_##type(struct snapshot_##type*, type*);                         \
+void   snapshot_reclaim_##type(struct snapshot_##type*);                                \
+void   snapshot_clear_##type(struct snapshot_##type*);
+
+#define DEFINE_SNAPSHOT(type)                                                           \
+SnapshotSlot* snapshot_slots_##type(int max_readers)                                    \
+{                                                                                       \
+    assert(max_readers > 0);                                                            \
+    SnapshotSlot* slots = aligned_alloc(SNAPSHOT_CACHE_LINE,                            \
+                                        sizeof(SnapshotSlot) * (size_t)max_readers);    \
+    assert(slots != NULL);                                                              \
+                                                                                        \
+    for (int i = 0; i < max_readers; i++)                                               \
+    {                                                                                   \
+        atomic_init(&slots[i].epoch, 0);                                                \
+        atomic_init(&slots[i].in_use, false);                                           \
+    }                                                                                   \
+    return slots;                                                                       \
+}                                                                                       \
+                                                                                        \
+int snapshot_attach_##type(struct snapshot_##type* snap)                                \
+{                                                                                       \
+    for (int i = 0; i < snap->_max_readers; i++)                                        \
+    {                                                                                   \
+        bool expected = false;                                                          \
+        if (atomic_compare_exchange_strong(&snap->_slots[i].in_use, &expected, true))   \
+            return i;                                                                   \
+    }                                                                                   \
+                                                                                        \
+    return SNAPSHOT_NO_READER;                                                          \
+}                                                                                       \
+                                                                                        \
+void snapshot_detach_##type(struct snapshot_##type* snap, int reader)                   \
+{                                                                                       \
+    if (reader < 0 || reader >= snap->_max_readers)                                     \
+        return;                                                                         \
+                                                                                        \
+    atomic_store_explicit(&snap->_slots[reader].epoch, 0, memory_order_release);        \
+    atomic_store_explicit(&snap->_slots[reader].in_use, false, memory_order_release);   \
+}                                                                                       \
+                                                                                        \
+type* snapshot_enter_##type(struct snapshot_##type* snap, int reader)                   \
+{                                                                                       \
+    if (reader < 0 || reader >= snap->_max_readers)                                     \
+        return NULL;                                                                    \
+                                                                                        \
+    /* announce the epoch before loading the pointer, the writer checks them */         \
+    /* in the opposite order, so one of the two always sees the other */                \
+    unsigned long epoch = atomic_load_explicit(&snap->_epoch, memory_order_acquire);    \
+    atomic_store_explicit(&snap->_slots[reader].epoch, epoch, memory_order_seq_cst);    \
+    return atomic_load_explicit(&snap->_current, memory_order_seq_cst);                 \
+}                                                                                       \
+                                                                                        \
+void snapshot_leave_##type(struct snapshot_##type* snap, int reader)                    \
+{                                                                                       \
+    if (reader < 0 || reader >= snap->_max_readers)                                     \
+        return;                                                                         \
+                                                                                        \
+    atomic_store_explicit(&snap->_slots[reader].epoch, 0, memory_order_release);        \
+}                                                                                       \
+                                                                                        \
+void snapshot_reclaim_##type(struct snapshot_##type* snap)                              \
+{                                                                                       \
+    unsigned long oldest = ULONG_MAX;                                                   \
+    for (int i = 0; i < snap->_max_readers; i++)                                        \
+    {                                                                                   \
+        unsigned long epoch = atomic_load_explicit(&snap->_slots[i].epoch,              \
+                                                   memory_order_seq_cst);               \
+        if (epoch != 0 && epoch < oldest)                                               \
+            oldest = epoch;                                                             \
+    }                                                                                   \
+                                                                                        \
+    size_t i = 0;                                                                       \
+    while (i < snap->_retired_count)                                                    \
+    {                                                                                   \
+        if (snap->_retired[i].epoch < oldest)                                           \
+        {                                                                               \
+            snap->_release(snap->_retired[i].item);                                     \
+            snap->_retired[i] = snap->_retired[--snap->_retired_count];                 \
+        }                                                                               \
+        else                                                                            \
+            i++;                                                                        \
+    }                                                                                   \
+}                                                                                       \
+                                                                                        \
+void snapshot_publish_##type(struct snapshot_##type* snap, type* next)                  \
+{                                                                                       \
+    type* old = atomic_exchange_explicit(&snap->_current, next, memory_order_seq_cst);  \
+    unsigned long epoch = atomic_fetch_add_explicit(&snap->_epoch, 1,                   \
+                                                    memory_order_seq_cst);              \
+                                                                                        \
+    if (old != NULL)                                                                    \
+    {                                                                                   \
+        if (snap->_retired_count >= snap->_retired_capacity)                            \
+        {                                                                               \
+            snap->_retired_capacity = (snap->_retired_capacity > 0) ?                   \
+                snap->_retired_capacity * 2 : 4;                                        \
+                                                                                        \
+            snapshot_retired_##type* tmp = realloc(snap->_retired,                      \
+                sizeof(snapshot_retired_##type) * snap->_retired_capacity);             \
+            assert(tmp != NULL);                                                        \
+            snap->_retired = tmp;                                                       \
+        }                                                                               \
+                                                                                        \
+        snapshot_retired_##type retired = { old, epoch };                               \
+        snap->_retired[snap->_retired_count++] = retired;                               \
+    }                                                                                   \
+                                                                                        \
+    snapshot_reclaim_##type(snap);                                                      \
+}                                                                                       \
+                                                                                        \
+void snapshot_clear_##type(struct snapshot_##type* snap)                                \
+{                                                                                       \
+    type* current = atomic_exchange(&snap->_current, NULL);                             \
+    if (current != NULL)                                                                \
+        snap->_release(current);                                                        \
+                                                                                        \
+    for (size_t i = 0; i < snap->_retired_count; i++)                                   \
+        snap->_release(snap->_retired[i].item);                                         \
+                                                                                        \
+    free(snap->_retired);                                                               \
+    free(snap->_slots);                                                                 \
+    snap->_slots = NULL;                                                                \
+    snap->_max_readers = 0;                                                             \
+    snap->_retired = NULL;                                                              \
+    snap->_retired_count = 0;                                                           \
+    snap->_retired_capacity = 0;                                                        \
+}
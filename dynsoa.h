@@ -0,0 +1,236 @@
+// Struct-of-arrays implementation in C based on C++ vector implementation
+
+/*  HOW TO USE:
+
+    Call SOA_ARRAY(name, (type1, field1), (type2, field2), ...) to generate a container
+    that stores each field in its own contiguous column, up to SOA_MAX_FIELDS fields.
+    Call constructor_soa_array(name) to define attributes and function pointers.
+    Call destructor_soa_array(soa) in order to clean up.
+    If array goes out of scope without destructor being called, a memory leak will occur.
+
+    Whole records are passed in and out as soa_row_##name values, but each column
+    is also exposed as a raw pointer under col.<field>, so a scan that only touches
+    one or two fields reads only those columns. Every column starts on a
+    SOA_ALIGNMENT byte boundary, so SIMD kernels may use aligned loads.
+
+    To use one instantiation from several files see DECLARE_SOA_ARRAY in README.
+
+    example:
+
+    SOA_ARRAY(particle, (float, x), (float, y), (int, id))
+
+    int main(void)
+    {
+        soa_array_particle soa = constructor_soa_array(particle);
+
+        soa.push_back(&soa, (soa_row_particle){ .x = 1.f, .y = 2.f, .id = 0 });
+        soa.push_back(&soa, (soa_row_particle){ .x = 3.f, .y = 4.f, .id = 1 });
+
+        float sum = 0.f;
+        for (size_t i = 0; i < soa.size(&soa); i++)
+            sum += soa.col.x[i];
+
+        destructor_soa_array(soa);
+
+        return 0;
+    }
+
+    Do not manually modify: _elements, _capacity, or the column pointers themselves.
+    Column contents may be read and written in place for indices below size().
+
+*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+#include <stdbool.h>
+
+#define SOA_MAX_FIELDS 8
+#define SOA_ALIGNMENT 64
+
+// columns are left NULL by the designated initialiser and allocated on first growth
+#define constructor_soa_array(name)                                                   \
+{                                                                                     \
+    ._elements = 0, ._capacity = 0,                                                   \
+    .push_back = soa_array_push_##name, .pop_back = soa_array_pop_back_##name,        \
+    .erase = soa_array_erase_##name, .clear = soa_array_clear_##name,                 \
+    .get = soa_array_get_##name, .set = soa_array_set_##name,                         \
+    .empty = soa_array_empty_##name, .size = soa_array_size_##name,                   \
+    .reserve = soa_array_reserve_##name, .shrink = soa_array_shrink_##name            \
+}
+
+#define destructor_soa_array(item) \
+    item.clear(&item)
+
+// preprocessor plumbing: apply a macro to every (type, field) pair
+// the per-field macros below receive (soa, type, field) and may refer to
+// the locals "row" and "index" of the generated function they are expanded in
+
+#define SOA_CAT(a, b)  SOA_CAT_(a, b)
+#define SOA_CAT_(a, b) a##b
+
+#define SOA_NARGS(...) SOA_NARGS_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define SOA_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+
+#define SOA_UNPACK(type, field)  type, field
+#define SOA_APPLY(m, soa, pair)  SOA_APPLY_(m, soa, SOA_UNPACK pair)
+#define SOA_APPLY_(m, ...)       m(__VA_ARGS__)
+
+#define SOA_FOR_EACH(m, soa, ...) SOA_CAT(SOA_FOR_EACH_, SOA_NARGS(__VA_ARGS__))(m, soa, __VA_ARGS__)
+#define SOA_FOR_EACH_1(m, soa, p)      SOA_APPLY(m, soa, p)
+#define SOA_FOR_EACH_2(m, soa, p, ...) SOA_APPLY(m, soa, p) SOA_FOR_EACH_1(m, soa, __VA_ARGS__)
+#define SOA_FOR_EACH_3(m, soa, p, ...) SOA_APPLY(m, soa, p) SOA_FOR_EACH_2(m, soa, __VA_ARGS__)
+#define SOA_FOR_EACH_4(m, soa, p, ...) SOA_APPLY(m, soa, p) SOA_FOR_EACH_3(m, soa, __VA_ARGS__)
+#define SOA_FOR_EACH_5(m, soa, p, ...) SOA_APPLY(m, soa, p) SOA_FOR_EACH_4(m, soa, __VA_ARGS__)
+#define SOA_FOR_EACH_6(m, soa, p, ...) SOA_APPLY(m, soa, p) SOA_FOR_EACH_5(m, soa, __VA_ARGS__)
+#define SOA_FOR_EACH_7(m, soa, p, ...) SOA_APPLY(m, soa, p) SOA_FOR_EACH_6(m, soa, __VA_ARGS__)
+#define SOA_FOR_EACH_8(m, soa, p, ...) SOA_APPLY(m, soa, p) SOA_FOR_EACH_7(m, soa, __VA_ARGS__)
+
+#define SOA_ROW_FIELD(soa, type, field) type field;
+#define SOA_COLUMN(soa, type, field)    type* field;
+#define SOA_LOAD(soa, type, field)      row.field = (soa)->col.field[index];
+#define SOA_STORE(soa, type, field)     (soa)->col.field[index] = row.field;
+#define SOA_FREE(soa, type, field)      free((soa)->col.field); (soa)->col.field = NULL;
+
+// realloc only guarantees malloc alignment, so columns are moved into a fresh aligned block
+#define SOA_REALLOC(soa, type, field)                                       \
+    {                                                                       \
+        size_t bytes = sizeof(type) * (soa)->_capacity;                     \
+        bytes = (bytes + SOA_ALIGNMENT - 1) & ~(size_t)(SOA_ALIGNMENT - 1); \
+        type* tmp = aligned_alloc(SOA_ALIGNMENT, bytes);                    \
+        assert(tmp != NULL);                                                \
+        if ((soa)->col.field != NULL)                                       \
+            memcpy(tmp, (soa)->col.field, sizeof(type) * (soa)->_elements); \
+        free((soa)->col.field);                                             \
+        (soa)->col.field = tmp;                                             \
+    }
+
+#define SOA_MOVE_DOWN(soa, type, field)                                     \
+    memmove(&(soa)->col.field[index], &(soa)->col.field[index + 1],         \
+            ((soa)->_elements - index - 1) * sizeof(type));
+
+#define SOA_ARRAY(name, ...)                                                     \
+    DECLARE_SOA_ARRAY(name, __VA_ARGS__)                                         \
+    DEFINE_SOA_ARRAY(name, __VA_ARGS__)
+
+#define DECLARE_SOA_ARRAY(name, ...)                                             \
+typedef struct soa_row_##name                                                    \
+{                                                                                \
+    SOA_FOR_EACH(SOA_ROW_FIELD, _, __VA_ARGS__)                                  \
+} soa_row_##name;                                                                \
+                                                                                 \
+typedef struct soa_array_##name                                                  \
+{                                                                                \
+    struct                                                                       \
+    {                                                                            \
+        SOA_FOR_EACH(SOA_COLUMN, _, __VA_ARGS__)                                 \
+    } col;                                                                       \
+    size_t _elements;                                                            \
+    size_t _capacity;                                                            \
+    void   (*push_back)(struct soa_array_##name*, soa_row_##name);               \
+    void   (*pop_back)(struct soa_array_##name*);                                \
+    void   (*erase)(struct soa_array_##name*, size_t);                           \
+    soa_row_##name (*get)(struct soa_array_##name*, size_t);                     \
+    void   (*set)(struct soa_array_##name*, size_t, soa_row_##name);             \
+    bool   (*empty)(struct soa_array_##name*);                                   \
+    size_t (*size)(struct soa_array_##name*);                                    \
+    void   (*clear)(struct soa_array_##name*);                                   \
+    void   (*reserve)(struct soa_array_##name*, size_t);                         \
+    void   (*shrink)(struct soa_array_##name*);                                  \
+} soa_array_##name;                                                              \
+                                                                                 \
+void   soa_array_push_##name(struct soa_array_##name*, soa_row_##name);          \
+void   soa_array_pop_back_##name(struct soa_array_##name*);                      \
+void   soa_array_erase_##name(struct soa_array_##name*, size_t);                 \
+soa_row_##name soa_array_get_##name(struct soa_array_##name*, size_t);           \
+void   soa_array_set_##name(struct soa_array_##name*, size_t, soa_row_##name);   \
+bool   soa_array_empty_##name(struct soa_array_##name*);                         \
+size_t soa_array_size_##name(struct soa_array_##name*);                          \
+void   soa_array_clear_##name(struct soa_array_##name*);                         \
+void   soa_array_reserve_##name(struct soa_array_##name*, size_t);               \
+void   soa_array_shrink_##name(struct soa_array_##name*);
+
+#define DEFINE_SOA_ARRAY(name, ...)                                              \
+void soa_array_resize_##name(struct soa_array_##name* soa, size_t capacity)      \
+{                                                                                \
+    soa->_capacity = capacity;                                                   \
+    SOA_FOR_EACH(SOA_REALLOC, soa, __VA_ARGS__)                                  \
+}                                                                                \
+                                                                                 \
+void soa_array_push_##name(struct soa_array_##name* soa, soa_row_##name row)     \
+{                                                                                \
+    if (soa->_elements >= soa->_capacity)                                        \
+        soa_array_resize_##name(soa, (soa->_capacity > 0) ?                      \
+            soa->_capacity * 2 : 1);                                             \
+                                                                                 \
+    size_t index = soa->_elements;                                               \
+    SOA_FOR_EACH(SOA_STORE, soa, __VA_ARGS__)                                    \
+    soa->_elements++;                                                            \
+}                                                                                \
+                                                                                 \
+void soa_array_pop_back_##name(struct soa_array_##name* soa)                     \
+{                                                                                \
+    assert(soa->_elements > 0);                                                  \
+    soa->_elements--;                                                            \
+}                                                                                \
+                                                                                 \
+void soa_array_erase_##name(struct soa_array_##name* soa, size_t index)          \
+{                                                                                \
+    assert(index < soa->_elements);                                              \
+    SOA_FOR_EACH(SOA_MOVE_DOWN, soa, __VA_ARGS__)                                \
+    soa->_elements--;                                                            \
+}                                                                                \
+                                                                                 \
+soa_row_##name soa_array_get_##name(struct soa_array_##name* soa, size_t index)  \
+{                                                                                \
+    assert(index < soa->_elements);                                              \
+    soa_row_##name row;                                                          \
+    SOA_FOR_EACH(SOA_LOAD, soa, __VA_ARGS__)                                     \
+    return row;                                                                  \
+}                                                                                \
+                                                                                 \
+void soa_array_set_##name(struct soa_array_##name* soa, size_t index,            \
+                          soa_row_##name row)                                    \
+{                                                                                \
+    assert(index < soa->_elements);                                              \
+    SOA_FOR_EACH(SOA_STORE, soa, __VA_ARGS__)                                    \
+}                                                                                \
+                                                                                 \
+bool soa_array_empty_##name(struct soa_array_##name* soa)                        \
+{                                                                                \
+    return (soa->_elements == 0);                                                \
+}                                                                                \
+                                                                                 \
+size_t soa_array_size_##name(struct soa_array_##name* soa)                       \
+{                                                                                \
+    return soa->_elements;                                                       \
+}                                                                                \
+                                                                                 \
+void soa_array_clear_##name(struct soa_array_##name* soa)                        \
+{                                                                                \
+    SOA_FOR_EACH(SOA_FREE, soa, __VA_ARGS__)                                     \
+    soa->_elements = 0;                                                          \
+    soa->_capacity = 0;                                                          \
+}                                                                                \
+                                                                                 \
+void soa_array_reserve_##name(struct soa_array_##name* soa, size_t amount)       \
+{                                                                                \
+    if (amount <= soa->_capacity)                                                \
+        return;                                                                  \
+                                                                                 \
+    soa_array_resize_##name(soa, amount);                                        \
+}                                                                                \
+                                                                                 \
+void soa_array_shrink_##name(struct soa_array_##name* soa)                       \
+{                                                                                \
+    if (soa->_elements == soa->_capacity)                                        \
+        return;                                                                  \
+                                                                                 \
+    if (soa->_elements == 0)                                                     \
+        soa_array_clear_##name(soa);                                             \
+    else                                                                         \
+        soa_array_resize_##name(soa, soa->_elements);                            \
+}
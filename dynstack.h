@@ -9,6 +9,8 @@
     Call destructor(stk) in order to clean up.
     If stack goes out of scope without destructor being called, a memory leak will occur.
 
+    To use one instantiation from several files see DECLARE_STACK in README.
+
     example:
 
     STACK(int)
@@ -57,7 +59,12 @@
         item._type_size = 0
 #endif
 
-#define STACK(type) typedef struct stack_##type                             \
+#define STACK(type)                                                         \
+    DECLARE_STACK(type)                                                     \
+    DEFINE_STACK(type)
+
+#define DECLARE_STACK(type)                                                 \
+typedef struct stack_##type                                                 \
 {                                                                           \
     type*  _array;                                                          \
     size_t _elements;                                                       \
@@ -70,6 +77,13 @@
     size_t (*size)(struct stack_##type*);                                   \
 } stack_##type;                                                             \
                                                                             \
+void   stack_push_##type(struct stack_##type*, type);                       \
+void   stack_pop_##type(struct stack_##type*);                              \
+type   stack_top_##type(struct stack_##type*);                              \
+bool   stack_empty_##type(struct stack_##type*);                            \
+size_t stack_size_##type(struct stack_##type*);
+
+#define DEFINE_STACK(type)                                                  \
 void stack_push_##type(struct stack_##type* stk, type elem)                 \
 {                                                                           \
     if (stk->_elements >= stk->_capacity)                                   \
@@ -0,0 +1,197 @@
+#include "dynstrset.h"
+
+static StringEntry* s_arena_alloc(StringSet* set, size_t length)
+{
+    size_t align = _Alignof(StringEntry);
+    size_t need = (sizeof(StringEntry) + length + 1 + align - 1) & ~(align - 1);
+
+    StringChunk* chunk = set->_chunks;
+    if (chunk == NULL || chunk->capacity - chunk->used < need)
+    {
+        size_t capacity = (need > STRING_SET_CHUNK) ? need : STRING_SET_CHUNK;
+
+        chunk = malloc(sizeof(StringChunk) + capacity);
+        assert(chunk != NULL);
+        chunk->used = 0;
+        chunk->capacity = capacity;
+
+        // an oversized key gets a private chunk behind the current one so the
+        // remaining space in the current chunk is not abandoned
+        if (need > STRING_SET_CHUNK && set->_chunks != NULL)
+        {
+            chunk->next = set->_chunks->next;
+            set->_chunks->next = chunk;
+        }
+        else
+        {
+            chunk->next = set->_chunks;
+            set->_chunks = chunk;
+        }
+    }
+
+    StringEntry* entry = (StringEntry*)(chunk->data + chunk->used);
+    chunk->used += need;
+
+    return entry;
+}
+
+static void s_resize(StringSet* set, size_t capacity)
+{
+    StringSlot* old = set->_table;
+    size_t old_capacity = set->_capacity;
+
+    set->_capacity = capacity;
+    set->_table = malloc(sizeof(StringSlot) * capacity);
+    assert(set->_table);
+    memset(set->_table, -1, sizeof(StringSlot) * capacity);
+
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (old[i].id == STRING_SET_NONE)
+            continue;
+
+        unsigned int index = get_index(old[i].hash, capacity);
+        while (set->_table[index].id != STRING_SET_NONE)
+            index = (index + 1) % capacity;
+
+        set->_table[index] = old[i];
+    }
+
+    free(old);
+}
+
+// returns the slot holding the key, or the empty slot where it would be inserted
+static unsigned int s_probe(StringSet* set, const char* key, size_t length, unsigned long hash)
+{
+    unsigned int index = get_index(hash, set->_capacity);
+
+    while (true)
+    {
+        StringSlot slot = set->_table[index];
+
+        if (slot.id == STRING_SET_NONE)
+            break;
+
+        if (slot.hash == hash)
+        {
+            StringEntry* entry = set->_entries[slot.id];
+            if (entry->length == length && memcmp(entry->data, key, length) == 0)
+                break;
+        }
+
+        index = (index + 1) % set->_capacity;
+    }
+
+    return index;
+}
+
+size_t string_set_find_n(StringSet* set, const char* key, size_t length)
+{
+    if (set->_elements < 1)
+        return STRING_SET_NONE;
+
+    unsigned long hash = djb2((const unsigned char*)key, length);
+    unsigned int index = s_probe(set, key, length, hash);
+
+    return set->_table[index].id;
+}
+
+size_t string_set_find(StringSet* set, const char* key)
+{
+    return string_set_find_n(set, key, strlen(key));
+}
+
+bool string_set_contains(StringSet* set, const char* key)
+{
+    return string_set_find(set, key) != STRING_SET_NONE;
+}
+
+size_t string_set_intern_n(StringSet* set, const char* key, size_t length)
+{
+    if (set->_capacity == 0)
+        s_resize(set, 8);
+    else
+    {
+        float load_factor = ((float)set->_elements / (float)set->_capacity);
+        if (load_factor >= 0.75f)
+            s_resize(set, set->_capacity * 2);
+    }
+
+    unsigned long hash = djb2((const unsigned char*)key, length);
+    unsigned int index = s_probe(set, key, length, hash);
+
+    if (set->_table[index].id != STRING_SET_NONE)
+        return set->_table[index].id;
+
+    if (set->_elements >= set->_entries_capacity)
+    {
+        set->_entries_capacity = (set->_entries_capacity > 0) ?
+            set->_entries_capacity * 2 : 8;
+
+        StringEntry** tmp = realloc(set->_entries, sizeof(StringEntry*) * set->_entries_capacity);
+        assert(tmp != NULL);
+        set->_entries = tmp;
+    }
+
+    StringEntry* entry = s_arena_alloc(set, length);
+    entry->hash = hash;
+    entry->length = length;
+    memcpy(entry->data, key, length);
+    entry->data[length] = '\0';
+
+    size_t id = set->_elements++;
+    set->_entries[id] = entry;
+
+    StringSlot slot = { hash, id };
+    set->_table[index] = slot;
+
+    return id;
+}
+
+size_t string_set_intern(StringSet* set, const char* key)
+{
+    return string_set_intern_n(set, key, strlen(key));
+}
+
+const char* string_set_get(StringSet* set, size_t id)
+{
+    assert(id < set->_elements);
+    return set->_entries[id]->data;
+}
+
+size_t string_set_length(StringSet* set, size_t id)
+{
+    assert(id < set->_elements);
+    return set->_entries[id]->length;
+}
+
+bool string_set_empty(StringSet* set)
+{
+    return (set->_elements == 0);
+}
+
+size_t string_set_size(StringSet* set)
+{
+    return set->_elements;
+}
+
+void string_set_clear(StringSet* set)
+{
+    StringChunk* chunk = set->_chunks;
+    while (chunk != NULL)
+    {
+        StringChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    free(set->_table);
+    free(set->_entries);
+
+    set->_table = NULL;
+    set->_capacity = 0;
+    set->_elements = 0;
+    set->_entries = NULL;
+    set->_entries_capacity = 0;
+    set->_chunks = NULL;
+}
@@ -0,0 +1,118 @@
+// String set / interner in C, companion to the SET container for string keys
+
+/*  HOW TO USE:
+
+    Call constructor_string_set() to define attributes and function pointers.
+    Call destructor_string_set(set) in order to clean up.
+    If set goes out of scope without destructor being called, a memory leak will occur.
+    Build dynstrset.c and dynset.c with the program, or link the dyncontainers library.
+
+    Unlike SET(type), keys are copied into an arena owned by the set, so the caller's
+    buffer may be reused straight after interning. Every key is stored once together
+    with its length and full hash, and is identified by a stable id (0, 1, 2, ...)
+    that stays valid, along with the pointer returned by get(), until clear().
+
+    example:
+
+    int main(void)
+    {
+        StringSet set = constructor_string_set();
+
+        size_t a = set.intern(&set, "alpha");
+        size_t b = set.intern(&set, "beta");
+        size_t c = set.intern(&set, "alpha");    // c == a
+
+        printf("%s\n", set.get(&set, b));
+
+        destructor_string_set(set);
+
+        return 0;
+    }
+
+    Do not manually modify: _table, _entries, _chunks or any of the counters.
+    Use function pointers to do so.
+
+*/
+
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "dynset.h"
+
+#define STRING_SET_NONE ((size_t)-1)
+#define STRING_SET_CHUNK 65536
+
+#define constructor_string_set()                                             \
+{                                                                            \
+    ._table = NULL, ._capacity = 0, ._elements = 0,                          \
+    ._entries = NULL, ._entries_capacity = 0, ._chunks = NULL,               \
+    .intern = string_set_intern, .intern_n = string_set_intern_n,            \
+    .find = string_set_find, .find_n = string_set_find_n,                    \
+    .contains = string_set_contains, .get = string_set_get,                  \
+    .length = string_set_length, .empty = string_set_empty,                  \
+    .size = string_set_size, .clear = string_set_clear                       \
+}
+
+#define destructor_string_set(item) \
+    item.clear(&item)
+
+// a key as laid out in the arena: hash and length inline, bytes (null terminated) behind them
+typedef struct StringEntry
+{
+    unsigned long hash;
+    size_t length;
+    char data[];
+} StringEntry;
+
+// table slots keep a copy of the hash so most mismatches never touch the arena
+typedef struct StringSlot
+{
+    unsigned long hash;
+    size_t id;
+} StringSlot;
+
+typedef struct StringChunk
+{
+    struct StringChunk* next;
+    size_t used;
+    size_t capacity;
+    unsigned char data[];
+} StringChunk;
+
+typedef struct StringSet
+{
+    StringSlot* _table;
+    size_t _capacity;
+    size_t _elements;
+
+    StringEntry** _entries;
+    size_t _entries_capacity;
+    StringChunk* _chunks;
+
+    size_t (*intern)(struct StringSet*, const char*);
+    size_t (*intern_n)(struct StringSet*, const char*, size_t);
+    size_t (*find)(struct StringSet*, const char*);
+    size_t (*find_n)(struct StringSet*, const char*, size_t);
+    bool (*contains)(struct StringSet*, const char*);
+    const char* (*get)(struct StringSet*, size_t);
+    size_t (*length)(struct StringSet*, size_t);
+    bool (*empty)(struct StringSet*);
+    size_t (*size)(struct StringSet*);
+    void (*clear)(struct StringSet*);
+} StringSet;
+
+size_t string_set_find_n(StringSet* set, const char* key, size_t length);
+size_t string_set_find(StringSet* set, const char* key);
+bool string_set_contains(StringSet* set, const char* key);
+size_t string_set_intern_n(StringSet* set, const char* key, size_t length);
+size_t string_set_intern(StringSet* set, const char* key);
+const char* string_set_get(StringSet* set, size_t id);
+size_t string_set_length(StringSet* set, size_t id);
+bool string_set_empty(StringSet* set);
+size_t string_set_size(StringSet* set);
+void string_set_clear(StringSet* set);
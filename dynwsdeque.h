@@ -0,0 +1,226 @@
+// Chase-Lev work-stealing deque in C, the concurrent counterpart of the STACK container
+
+// TODO: test
+
+/*  HOW TO USE:
+
+    Call WS_DEQUE(type) with the desired type, multiple types can be used.
+    Call constructor_ws_deque(type) to define attributes and function pointers.
+    Call destructor_ws_deque(deq) in order to clean up, once no thread uses it anymore.
+    If deque goes out of scope without destructor being called, a memory leak will occur.
+
+    One thread owns the deque and uses push and pop at the bottom, exactly like a STACK.
+    Any other thread may call steal, which takes the oldest element from the top.
+    None of the three take a lock (C11 atomics, after Le, Pop, Cohen, Zappa Nardelli 2013).
+
+    When the deque grows, the old buffer may still be read by a thief that loaded it
+    just before, so it is not freed straight away: it is chained behind the new one and
+    released by clear/destructor. Buffers double, so this never holds more than the
+    current buffer's size again.
+
+    To use one instantiation from several files see DECLARE_WS_DEQUE in README.
+
+    example:
+
+    WS_DEQUE(int)
+
+    int main(void)
+    {
+        ws_deque_int deq = constructor_ws_deque(int);
+
+        deq.push(&deq, 1);                  // owner thread
+        deq.push(&deq, 2);
+
+        int value;
+        if (deq.steal(&deq, &value))        // any thread, gets 1
+            printf("%d\n", value);
+        if (deq.pop(&deq, &value))          // owner thread, gets 2
+            printf("%d\n", value);
+
+        destructor_ws_deque(deq);
+
+        return 0;
+    }
+
+    Slots are accessed with relaxed atomics, since a thief may read a slot while the
+    owner overwrites it after wrap-around. type must therefore be lock-free when made
+    _Atomic (in practice at most 8 bytes: an index or a pointer to the real task);
+    this is asserted when the buffer is allocated.
+
+    Do not manually modify: _top, _bottom or _buffer.
+    Use function pointers to do so.
+
+*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#define WS_DEQUE_MIN 32
+#define WS_DEQUE_CACHE_LINE 64
+
+#define constructor_ws_deque(type)                                  \
+{                                                                   \
+    ._top = 0, ._bottom = 0, ._buffer = NULL,                       \
+    .push = ws_deque_push_##type, .pop = ws_deque_pop_##type,       \
+    .steal = ws_deque_steal_##type,                                 \
+    .empty = ws_deque_empty_##type, .size = ws_deque_size_##type,   \
+    .clear = ws_deque_clear_##type                                  \
+}
+
+#define destructor_ws_deque(item) \
+    item.clear(&item)
+
+#define WS_DEQUE(type)                                                                   \
+    DECLARE_WS_DEQUE(type)                                                               \
+    DEFINE_WS_DEQUE(type)
+
+#define DECLARE_WS_DEQUE(type)                                                           \
+typedef struct ws_buffer_##type                                                          \
+{                                                                                        \
+    long _capacity;                                                                      \
+    struct ws_buffer_##type* _previous;                                                  \
+    _Atomic(type) _array[];                                                              \
+} ws_buffer_##type;                                                                      \
+                                                                                         \
+typedef struct ws_deque_##type                                                           \
+{                                                                                        \
+    _Alignas(WS_DEQUE_CACHE_LINE) atomic_long _top;                                      \
+    _Alignas(WS_DEQUE_CACHE_LINE) atomic_long _bottom;                                   \
+    _Atomic(ws_buffer_##type*) _buffer;                                                  \
+    void   (*push)(struct ws_deque_##type*, type);                                       \
+    bool   (*pop)(struct ws_deque_##type*, type*);                                       \
+    bool   (*steal)(struct ws_deque_##type*, type*);                                     \
+    bool   (*empty)(struct ws_deque_##type*);                                            \
+    size_t (*size)(struct ws_deque_##type*);                                             \
+    void   (*clear)(struct ws_deque_##type*);                                            \
+} ws_deque_##type;                                                                       \
+                                                                                         \
+void   ws_deque_push_##type(struct ws_deque_##type*, type);                              \
+bool   ws_deque_pop_##type(struct ws_deque_##type*, type*);                              \
+bool   ws_deque_steal_##type(struct ws_deque_##type*, type*);                            \
+size_t ws_deque_size_##type(struct ws_deque_##type*);                                    \
+bool   ws_deque_empty_##type(struct ws_deque_##type*);                                   \
+void   ws_deque_clear_##type(struct ws_deque_##type*);
+
+#define DEFINE_WS_DEQUE(type)                                                            \
+ws_buffer_##type* ws_deque_grow_##type(struct ws_deque_##type* deq,                      \
+                                       ws_buffer_##type* old, long bottom, long top)     \
+{                                                                                        \
+    long capacity = (old != NULL) ? old->_capacity * 2 : WS_DEQUE_MIN;                   \
+                                                                                         \
+    ws_buffer_##type* buf = malloc(sizeof(ws_buffer_##type) +                            \
+                                   sizeof(_Atomic(type)) * capacity);                    \
+    assert(buf != NULL);                                                                 \
+    assert(atomic_is_lock_free(&buf->_array[0]));                                        \
+    buf->_capacity = capacity;                                                           \
+    buf->_previous = old;                                                                \
+                                                                                         \
+    for (long i = top; i < bottom; i++)                                                  \
+    {                                                                                    \
+        type elem = atomic_load_explicit(&old->_array[i & (old->_capacity - 1)],         \
+                                         memory_order_relaxed);                          \
+        atomic_store_explicit(&buf->_array[i & (capacity - 1)], elem,                    \
+                              memory_order_relaxed);                                     \
+    }                                                                                    \
+                                                                                         \
+    atomic_store_explicit(&deq->_buffer, buf, memory_order_release);                     \
+    return buf;                                                                          \
+}                                                                                        \
+                                                                                         \
+void ws_deque_push_##type(struct ws_deque_##type* deq, type elem)                        \
+{                                                                                        \
+    long b = atomic_load_explicit(&deq->_bottom, memory_order_relaxed);                  \
+    long t = atomic_load_explicit(&deq->_top, memory_order_acquire);                     \
+    ws_buffer_##type* buf = atomic_load_explicit(&deq->_buffer, memory_order_relaxed);   \
+                                                                                         \
+    if (buf == NULL || b - t > buf->_capacity - 1)                                       \
+        buf = ws_deque_grow_##type(deq, buf, b, t);                                      \
+                                                                                         \
+    atomic_store_explicit(&buf->_array[b & (buf->_capacity - 1)], elem,                  \
+                          memory_order_relaxed);                                         \
+    atomic_store_explicit(&deq->_bottom, b + 1, memory_order_release);                   \
+}                                                                                        \
+                                                                                         \
+bool ws_deque_pop_##type(struct ws_deque_##type* deq, type* out)                         \
+{                                                                                        \
+    long b = atomic_load_explicit(&deq->_bottom, memory_order_relaxed) - 1;              \
+    ws_buffer_##type* buf = atomic_load_explicit(&deq->_buffer, memory_order_relaxed);   \
+    atomic_store_explicit(&deq->_bottom, b, memory_order_relaxed);                       \
+    atomic_thread_fence(memory_order_seq_cst);                                           \
+    long t = atomic_load_explicit(&deq->_top, memory_order_relaxed);                     \
+                                                                                         \
+    if (t > b)                                                                           \
+    {                                                                                    \
+        atomic_store_explicit(&deq->_bottom, b + 1, memory_order_relaxed);               \
+        return false;                                                                    \
+    }                                                                                    \
+                                                                                         \
+    type elem = atomic_load_explicit(&buf->_array[b & (buf->_capacity - 1)],             \
+                                     memory_order_relaxed);                              \
+    if (t == b)                                                                          \
+    {                                                                                    \
+        /* last element, race the thieves for it */                                      \
+        bool won = atomic_compare_exchange_strong_explicit(&deq->_top, &t, t + 1,        \
+            memory_order_seq_cst, memory_order_relaxed);                                 \
+        atomic_store_explicit(&deq->_bottom, b + 1, memory_order_relaxed);               \
+        if (!won)                                                                        \
+            return false;                                                                \
+    }                                                                                    \
+                                                                                         \
+    *out = elem;                                                                         \
+    return true;                                                                         \
+}                                                                                        \
+                                                                                         \
+bool ws_deque_steal_##type(struct ws_deque_##type* deq, type* out)                       \
+{                                                                                        \
+    long t = atomic_load_explicit(&deq->_top, memory_order_acquire);                     \
+    atomic_thread_fence(memory_order_seq_cst);                                           \
+    long b = atomic_load_explicit(&deq->_bottom, memory_order_acquire);                  \
+                                                                                         \
+    if (t >= b)                                                                          \
+        return false;                                                                    \
+                                                                                         \
+    ws_buffer_##type* buf = atomic_load_explicit(&deq->_buffer, memory_order_acquire);   \
+    type elem = atomic_load_explicit(&buf->_array[t & (buf->_capacity - 1)],             \
+                                     memory_order_relaxed);                              \
+                                                                                         \
+    if (!atomic_compare_exchange_strong_explicit(&deq->_top, &t, t + 1,                  \
+            memory_order_seq_cst, memory_order_relaxed))                                 \
+        return false;                                                                    \
+                                                                                         \
+    *out = elem;                                                                         \
+    return true;                                                                         \
+}                                                                                        \
+                                                                                         \
+size_t ws_deque_size_##type(struct ws_deque_##type* deq)                                 \
+{                                                                                        \
+    long b = atomic_load_explicit(&deq->_bottom, memory_order_relaxed);                  \
+    long t = atomic_load_explicit(&deq->_top, memory_order_relaxed);                     \
+    return (b > t) ? (size_t)(b - t) : 0;                                                \
+}                                                                                        \
+                                                                                         \
+bool ws_deque_empty_##type(struct ws_deque_##type* deq)                                  \
+{                                                                                        \
+    return ws_deque_size_##type(deq) == 0;                                               \
+}                                                                                        \
+                                                                                         \
+void ws_deque_clear_##type(struct ws_deque_##type* deq)                                  \
+{                                                                                        \
+    ws_buffer_##type* buf = atomic_load_explicit(&deq->_buffer, memory_order_relaxed);   \
+    while (buf != NULL)                                                                  \
+    {                                                                                    \
+        ws_buffer_##type* previous = buf->_previous;                                     \
+        free(buf);                                                                       \
+        buf = previous;                                                                  \
+    }                                                                                    \
+                                                                                         \
+    atomic_store_explicit(&deq->_buffer, NULL, memory_order_relaxed);                    \
+    atomic_store_explicit(&deq->_top, 0, memory_order_relaxed);                          \
+    atomic_store_explicit(&deq->_bottom, 0, memory_order_relaxed);                       \
+}
@@ -0,0 +1,328 @@
+// Test for IntSet against a reference bitmap: container conversions (array to bitmap
+// at INT_SET_ARRAY_MAX values and back on erase), run containers from optimize
+// including a full 65536 value chunk, updates after optimize, and union,
+// intersection, difference and is_subset on sets mixing all three container kinds.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dynintset.h"
+
+#define CHUNKS 16
+#define DOMAIN ((uint32_t)CHUNKS << 16)
+
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+// a reference set over [0, DOMAIN), one byte per value
+typedef struct Reference
+{
+    unsigned char has[DOMAIN];
+} Reference;
+
+static uint32_t out[DOMAIN];
+
+// xorshift, so the test is reproducible everywhere
+static uint32_t rng_state = 2463534242u;
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void put(IntSet* set, Reference* ref, uint32_t value)
+{
+    set->insert(set, value);
+    ref->has[value] = 1;
+}
+
+static void drop(IntSet* set, Reference* ref, uint32_t value)
+{
+    set->erase(set, value);
+    ref->has[value] = 0;
+}
+
+// containers sorted by key and never empty, arrays no larger than INT_SET_ARRAY_MAX,
+// bitmaps only above it
+static bool well_formed(IntSet* set)
+{
+    for (size_t i = 0; i < set->_count; i++)
+    {
+        IntContainer* c = &set->_containers[i];
+        if (c->cardinality == 0 || (i > 0 && set->_containers[i - 1].key >= c->key))
+            return false;
+        if (c->kind == INT_CONTAINER_ARRAY &&
+            (c->n != c->cardinality || c->cardinality > INT_SET_ARRAY_MAX))
+            return false;
+        if (c->kind == INT_CONTAINER_BITMAP && c->cardinality <= INT_SET_ARRAY_MAX)
+            return false;
+    }
+    return true;
+}
+
+static bool matches(IntSet* set, const Reference* ref)
+{
+    if (!well_formed(set))
+        return false;
+
+    size_t expected = 0;
+    for (uint32_t v = 0; v < DOMAIN; v++)
+    {
+        expected += ref->has[v];
+        if (set->contains(set, v) != (ref->has[v] != 0))
+            return false;
+    }
+    if (set->size(set) != expected)
+        return false;
+
+    // to_array must list exactly the reference values in ascending order
+    size_t n = set->to_array(set, out);
+    if (n != expected)
+        return false;
+
+    size_t k = 0;
+    for (uint32_t v = 0; v < DOMAIN; v++)
+    {
+        if (ref->has[v] && out[k++] != v)
+            return false;
+    }
+    return true;
+}
+
+static int kind_of(IntSet* set, uint16_t key)
+{
+    for (size_t i = 0; i < set->_count; i++)
+    {
+        if (set->_containers[i].key == key)
+            return (int)set->_containers[i].kind;
+    }
+    return -1;
+}
+
+static void test_conversions(void)
+{
+    static Reference ref;
+    memset(&ref, 0, sizeof(ref));
+    IntSet set = constructor_int_set();
+
+    // every other value, so optimize never prefers runs
+    for (uint32_t i = 0; i < INT_SET_ARRAY_MAX; i++)
+        put(&set, &ref, 2 * i);
+    CHECK(kind_of(&set, 0) == INT_CONTAINER_ARRAY);
+    CHECK(matches(&set, &ref));
+
+    put(&set, &ref, 2 * INT_SET_ARRAY_MAX);
+    CHECK(kind_of(&set, 0) == INT_CONTAINER_BITMAP);
+    CHECK(matches(&set, &ref));
+
+    // duplicates change nothing on either side of the boundary
+    put(&set, &ref, 0);
+    CHECK(set.size(&set) == INT_SET_ARRAY_MAX + 1);
+
+    drop(&set, &ref, 2);
+    CHECK(kind_of(&set, 0) == INT_CONTAINER_ARRAY);
+    CHECK(matches(&set, &ref));
+
+    drop(&set, &ref, 3);
+    CHECK(matches(&set, &ref));
+
+    for (uint32_t i = 0; i <= INT_SET_ARRAY_MAX; i++)
+        drop(&set, &ref, 2 * i);
+    CHECK(set.empty(&set));
+    CHECK(set._count == 0);
+
+    destructor_int_set(set);
+}
+
+static void test_runs(void)
+{
+    static Reference ref;
+    memset(&ref, 0, sizeof(ref));
+    IntSet set = constructor_int_set();
+
+    for (uint32_t v = 1u << 16; v < 2u << 16; v++)          // full chunk
+        put(&set, &ref, v);
+    for (uint32_t r = 0; r < 8; r++)                         // a few runs, as a bitmap
+        for (uint32_t v = 0; v < 1000; v++)
+            put(&set, &ref, (2u << 16) + r * 5000 + v);
+    for (uint32_t v = 0; v < 100; v++)                       // sparse, stays an array
+        put(&set, &ref, (3u << 16) + v * 97);
+
+    CHECK(kind_of(&set, 1) == INT_CONTAINER_BITMAP);
+    CHECK(kind_of(&set, 2) == INT_CONTAINER_BITMAP);
+    CHECK(matches(&set, &ref));
+
+    set.optimize(&set);
+    CHECK(kind_of(&set, 1) == INT_CONTAINER_RUN);
+    CHECK(kind_of(&set, 2) == INT_CONTAINER_RUN);
+    CHECK(kind_of(&set, 3) == INT_CONTAINER_ARRAY);
+    CHECK(set.size(&set) == 65536 + 8000 + 100);
+    CHECK(matches(&set, &ref));
+
+    // updates after optimize, including the ends of the full chunk
+    drop(&set, &ref, 1u << 16);
+    drop(&set, &ref, (2u << 16) - 1);
+    drop(&set, &ref, (1u << 16) + 30000);
+    put(&set, &ref, (2u << 16) + 4500);
+    put(&set, &ref, (2u << 16) + 999);
+    drop(&set, &ref, (2u << 16) + 5000);
+    CHECK(matches(&set, &ref));
+
+    set.optimize(&set);
+    CHECK(kind_of(&set, 1) == INT_CONTAINER_RUN);
+    CHECK(matches(&set, &ref));
+
+    for (uint32_t v = 0; v < 1000; v++)
+        put(&set, &ref, (1u << 16) + 30000 + v * 2);
+    CHECK(matches(&set, &ref));
+
+    destructor_int_set(set);
+}
+
+// chunk by chunk: sparse random (array), dense random (bitmap), long runs (run after
+// optimize) or nothing; two sparse chunks overflow INT_SET_ARRAY_MAX when united.
+// The second set's kind is shifted by key / 4, so across 16 chunks every pair meets
+static void fill_mixed(IntSet* set, Reference* ref, bool second)
+{
+    for (uint32_t key = 0; key < CHUNKS; key++)
+    {
+        uint32_t base = key << 16;
+        switch ((key + (second ? key / 4 : 0)) % 4)
+        {
+            case 0:
+                for (uint32_t i = 0; i < 3000; i++)
+                    put(set, ref, base + rng() % 65536);
+                break;
+            case 1:
+                for (uint32_t i = 0; i < 30000; i++)
+                    put(set, ref, base + rng() % 65536);
+                break;
+            case 2:
+                for (uint32_t r = 0; r < 20; r++)
+                {
+                    uint32_t start = rng() % 60000;
+                    uint32_t end = start + 1 + rng() % 5000;
+                    for (uint32_t v = start; v < end; v++)
+                        put(set, ref, base + v);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    set->optimize(set);
+}
+
+static void test_algebra(void)
+{
+    static Reference ra, rb, expected;
+    memset(&ra, 0, sizeof(ra));
+    memset(&rb, 0, sizeof(rb));
+
+    IntSet a = constructor_int_set();
+    IntSet b = constructor_int_set();
+    fill_mixed(&a, &ra, false);
+    fill_mixed(&b, &rb, true);
+    CHECK(matches(&a, &ra));
+    CHECK(matches(&b, &rb));
+
+    // every pair of container kinds meets in some chunk
+    bool pairs[3][3] = { { false } };
+    for (uint16_t key = 0; key < CHUNKS; key++)
+    {
+        if (kind_of(&a, key) >= 0 && kind_of(&b, key) >= 0)
+            pairs[kind_of(&a, key)][kind_of(&b, key)] = true;
+    }
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            CHECK(pairs[i][j]);
+
+    IntSet u = int_set_union(&a, &b);
+    for (uint32_t v = 0; v < DOMAIN; v++)
+        expected.has[v] = ra.has[v] | rb.has[v];
+    CHECK(matches(&u, &expected));
+
+    IntSet n = int_set_intersection(&a, &b);
+    for (uint32_t v = 0; v < DOMAIN; v++)
+        expected.has[v] = ra.has[v] & rb.has[v];
+    CHECK(matches(&n, &expected));
+
+    IntSet d = int_set_difference(&a, &b);
+    for (uint32_t v = 0; v < DOMAIN; v++)
+        expected.has[v] = ra.has[v] & !rb.has[v];
+    CHECK(matches(&d, &expected));
+
+    CHECK(int_set_is_subset(&a, &u));
+    CHECK(int_set_is_subset(&b, &u));
+    CHECK(int_set_is_subset(&n, &a));
+    CHECK(int_set_is_subset(&n, &b));
+    CHECK(int_set_is_subset(&d, &a));
+    CHECK(!int_set_is_subset(&a, &b));
+    CHECK(!int_set_is_subset(&u, &a));
+
+    // a value outside b in a chunk that b does hold must break the subset
+    IntSet c = int_set_intersection(&a, &b);
+    uint32_t extra = 0;
+    while (rb.has[extra] || !ra.has[extra])
+        extra++;
+    c.insert(&c, extra);
+    CHECK(!int_set_is_subset(&c, &b));
+    CHECK(int_set_is_subset(&c, &a));
+
+    destructor_int_set(a);
+    destructor_int_set(b);
+    destructor_int_set(u);
+    destructor_int_set(n);
+    destructor_int_set(d);
+    destructor_int_set(c);
+}
+
+static void test_random(void)
+{
+    static Reference ref;
+    memset(&ref, 0, sizeof(ref));
+    IntSet set = constructor_int_set();
+
+    for (int round = 0; round < 8; round++)
+    {
+        for (int i = 0; i < 40000; i++)
+        {
+            uint32_t value = rng() % DOMAIN;
+            if (rng() % 3 == 0)
+                drop(&set, &ref, value);
+            else
+                put(&set, &ref, value);
+        }
+        if (round % 2)
+            set.optimize(&set);
+        CHECK(matches(&set, &ref));
+    }
+
+    destructor_int_set(set);
+}
+
+int main(void)
+{
+    test_conversions();
+    test_runs();
+    test_algebra();
+    test_random();
+
+    IntSet high = constructor_int_set();
+    high.insert(&high, UINT32_MAX);
+    CHECK(high.contains(&high, UINT32_MAX) && !high.contains(&high, UINT32_MAX - 1));
+    destructor_int_set(high);
+
+    printf("int_set: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+// Test for SET insert_batch / contains_batch: a set filled in batches must match one
+// filled by single inserts and a reference table, across batch sizes that are not
+// multiples of SET_BATCH, batches that cross several resizes, n == 0 on an empty set,
+// and erases between batches that leave tombstones in the probe chains.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dynset.h"
+
+#define RANGE 20000         // values are drawn from [-RANGE / 2, RANGE / 2)
+#define QUERIES 5000
+
+SET(int)
+
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static unsigned char reference[RANGE];
+static int values[RANGE];
+static unsigned char found[(RANGE + 7) / 8];
+
+static bool present(int value)
+{
+    return reference[value + RANGE / 2] != 0;
+}
+
+static int random_value(void)
+{
+    return rand() % RANGE - RANGE / 2;
+}
+
+// every value in the range, looked up one by one and in one batch
+static bool agrees(Set_int* batched, Set_int* single)
+{
+    size_t expected = 0;
+    for (int i = 0; i < RANGE; i++)
+    {
+        values[i] = i - RANGE / 2;
+        expected += reference[i];
+    }
+    if (batched->size(batched) != expected || single->size(single) != expected)
+        return false;
+
+    batched->contains_batch(batched, values, RANGE, found);
+    for (int i = 0; i < RANGE; i++)
+    {
+        bool bit = (found[i / 8] >> (i % 8)) & 1;
+        if (bit != present(values[i]) ||
+            batched->contains(batched, values[i]) != present(values[i]) ||
+            single->contains(single, values[i]) != present(values[i]))
+            return false;
+    }
+    return true;
+}
+
+int main(void)
+{
+    srand(7);
+
+    Set_int batched = set_constructor(int);
+    Set_int single = set_constructor(int);
+
+    batched.insert_batch(&batched, values, 0);
+    CHECK(batched.empty(&batched));
+    batched.contains_batch(&batched, values, 0, found);
+    CHECK(agrees(&batched, &single));
+
+    // odd sizes around SET_BATCH and large ones that resize mid-call
+    size_t sizes[] = { 1, SET_BATCH - 1, SET_BATCH, SET_BATCH + 1, 3 * SET_BATCH + 5,
+                       1000, 0, 4099, 6001 };
+    size_t count = sizeof(sizes) / sizeof(sizes[0]);
+
+    for (size_t s = 0; s < count; s++)
+    {
+        size_t n = sizes[s];
+        int* batch = malloc(sizeof(int) * (n > 0 ? n : 1));
+
+        // repeats within and across batches are intended
+        for (size_t i = 0; i < n; i++)
+        {
+            batch[i] = random_value();
+            reference[batch[i] + RANGE / 2] = 1;
+            single.insert(&single, batch[i]);
+        }
+        size_t capacity = batched.capacity(&batched);
+        batched.insert_batch(&batched, batch, n);
+        CHECK(n < 1000 || batched.capacity(&batched) > capacity);
+        CHECK(agrees(&batched, &single));
+
+        // erase a third of what is present, then put some of it back
+        for (int i = 0; i < QUERIES; i++)
+        {
+            int value = random_value();
+            if (present(value) && rand() % 3 == 0)
+            {
+                reference[value + RANGE / 2] = 0;
+                batched.erase(&batched, value);
+                single.erase(&single, value);
+            }
+        }
+        batched.insert_batch(&batched, batch, n / 2);
+        for (size_t i = 0; i < n / 2; i++)
+        {
+            reference[batch[i] + RANGE / 2] = 1;
+            single.insert(&single, batch[i]);
+        }
+        CHECK(agrees(&batched, &single));
+
+        free(batch);
+    }
+
+    free(batched._array);
+    free(single._array);
+
+    printf("set_batch: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
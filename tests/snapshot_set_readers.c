@@ -0,0 +1,130 @@
+// Multi-reader test for SNAPSHOT(Set_int): the writer keeps publishing sets that
+// contain tombstones while READERS threads look keys up with contains and
+// contains_batch. Lookups must not write to the shared set, and every answer
+// must match the set's contents (even keys present, odd keys erased). Once every
+// slot is attached, further readers are refused without touching the snapshot.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "dynset.h"
+#include "dynsnapshot.h"
+
+#define READERS 4
+#define ROUNDS 200
+#define KEYS 4096
+
+SET(int)
+SNAPSHOT(Set_int)
+
+static snapshot_Set_int snap;
+static atomic_bool done;
+static atomic_long wrong;
+static atomic_long lookups;
+
+static void release_set(Set_int* set)
+{
+    free(set->_array);
+    free(set);
+}
+
+// inserts every key, then erases the odd ones so half the used buckets are tombstones
+static Set_int* build_set(void)
+{
+    Set_int* set = malloc(sizeof(Set_int));
+    *set = (Set_int)set_constructor(int);
+
+    for (int key = 0; key < KEYS; key++)
+        set->insert(set, key);
+    for (int key = 1; key < KEYS; key += 2)
+        set->erase(set, key);
+
+    return set;
+}
+
+static size_t count_tombstones(Set_int* set)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < set->_capacity; i++)
+        count += set->_array[i].hash != (unsigned long)-1 && set->_array[i].tombstone;
+    return count;
+}
+
+static void* reader(void* arg)
+{
+    (void)arg;
+    int slot = snap.attach(&snap);
+
+    int keys[KEYS];
+    unsigned char found[(KEYS + 7) / 8];
+    for (int key = 0; key < KEYS; key++)
+        keys[key] = key;
+
+    while (!atomic_load(&done))
+    {
+        Set_int* set = snap.enter(&snap, slot);
+        long errors = 0;
+
+        for (int key = 0; key < KEYS; key++)
+            errors += set->contains(set, key) != (key % 2 == 0);
+
+        set->contains_batch(set, keys, KEYS, found);
+        for (int key = 0; key < KEYS; key++)
+            errors += ((found[key / 8] >> (key % 8)) & 1) != (key % 2 == 0);
+
+        snap.leave(&snap, slot);
+
+        atomic_fetch_add(&wrong, errors);
+        atomic_fetch_add(&lookups, 2 * KEYS);
+    }
+
+    snap.detach(&snap, slot);
+    return NULL;
+}
+
+int main(void)
+{
+    snap = (snapshot_Set_int)constructor_snapshot(Set_int, release_set, READERS);
+
+    Set_int* first = build_set();
+    size_t tombstones = count_tombstones(first);
+    snap.publish(&snap, first);
+
+    pthread_t threads[READERS];
+    for (int i = 0; i < READERS; i++)
+        pthread_create(&threads[i], NULL, reader, NULL);
+
+    for (int round = 0; round < ROUNDS; round++)
+        snap.publish(&snap, build_set());
+
+    atomic_store(&done, true);
+    for (int i = 0; i < READERS; i++)
+        pthread_join(threads[i], NULL);
+
+    // all slots taken: the extra reader is refused and cannot disturb the others
+    int slots[READERS];
+    for (int i = 0; i < READERS; i++)
+        slots[i] = snap.attach(&snap);
+    int extra = snap.attach(&snap);
+    Set_int* current = atomic_load(&snap._current);
+
+    bool refused = extra == SNAPSHOT_NO_READER && snap.enter(&snap, extra) == NULL;
+    snap.leave(&snap, extra);
+    snap.detach(&snap, extra);
+    refused = refused && snap.enter(&snap, slots[0]) == current && current != NULL;
+    snap.leave(&snap, slots[0]);
+
+    for (int i = 0; i < READERS; i++)
+        snap.detach(&snap, slots[i]);
+
+    printf("tombstones %zu, lookups %ld, wrong %ld, extra reader refused %d\n",
+           tombstones, atomic_load(&lookups), atomic_load(&wrong), refused);
+
+    destructor_snapshot(snap);
+
+    return (tombstones > 0 && atomic_load(&wrong) == 0 && refused) ? 0 : 1;
+}
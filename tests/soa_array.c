@@ -0,0 +1,125 @@
+// Test for SOA_ARRAY: columns stay SOA_ALIGNMENT aligned through push, reserve and
+// shrink, every operation keeps the columns in sync, and a field may share its name
+// with a method (size) since columns live under col.
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "dynsoa.h"
+
+#define RECORDS 1000
+
+SOA_ARRAY(record, (double, x), (size_t, size), (char, tag), (int, id))
+
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static bool aligned(const void* column)
+{
+    return ((uintptr_t)column % SOA_ALIGNMENT) == 0;
+}
+
+static bool columns_aligned(soa_array_record* soa)
+{
+    return aligned(soa->col.x) && aligned(soa->col.size) &&
+           aligned(soa->col.tag) && aligned(soa->col.id);
+}
+
+static soa_row_record make_row(int id)
+{
+    return (soa_row_record){ .x = id * 0.5, .size = (size_t)id * 3,
+                             .tag = (char)('a' + id % 26), .id = id };
+}
+
+// row i must hold make_row(expected[i]) in every column
+static bool in_sync(soa_array_record* soa, const int* expected, size_t n)
+{
+    if (soa->size(soa) != n)
+        return false;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        soa_row_record want = make_row(expected[i]);
+        soa_row_record row = soa->get(soa, i);
+        if (row.x != want.x || row.size != want.size ||
+            row.tag != want.tag || row.id != want.id)
+            return false;
+        if (soa->col.x[i] != want.x || soa->col.size[i] != want.size ||
+            soa->col.tag[i] != want.tag || soa->col.id[i] != want.id)
+            return false;
+    }
+    return true;
+}
+
+int main(void)
+{
+    soa_array_record soa = constructor_soa_array(record);
+    int expected[RECORDS];
+    size_t n = 0;
+
+    CHECK(soa.empty(&soa));
+
+    for (int i = 0; i < RECORDS; i++)
+    {
+        soa.push_back(&soa, make_row(i));
+        expected[n++] = i;
+        CHECK(columns_aligned(&soa));
+    }
+    CHECK(in_sync(&soa, expected, n));
+
+    soa.reserve(&soa, 4 * RECORDS);
+    CHECK(soa._capacity == 4 * RECORDS);
+    CHECK(columns_aligned(&soa));
+    CHECK(in_sync(&soa, expected, n));
+
+    // erase from the front, the middle and the back
+    size_t erased[] = { 0, n / 2, n - 3 };
+    for (size_t e = 0; e < 3; e++)
+    {
+        soa.erase(&soa, erased[e]);
+        for (size_t i = erased[e]; i + 1 < n; i++)
+            expected[i] = expected[i + 1];
+        n--;
+    }
+    CHECK(in_sync(&soa, expected, n));
+
+    soa.pop_back(&soa);
+    soa.pop_back(&soa);
+    n -= 2;
+    CHECK(in_sync(&soa, expected, n));
+
+    soa.set(&soa, 7, make_row(5000));
+    expected[7] = 5000;
+    CHECK(in_sync(&soa, expected, n));
+
+    soa.shrink(&soa);
+    CHECK(soa._capacity == n);
+    CHECK(columns_aligned(&soa));
+    CHECK(in_sync(&soa, expected, n));
+
+    // shrink to nothing, then grow again from empty columns
+    while (!soa.empty(&soa))
+        soa.pop_back(&soa);
+    n = 0;
+    soa.shrink(&soa);
+    CHECK(soa._capacity == 0);
+    CHECK(soa.col.x == NULL && soa.col.size == NULL);
+
+    soa.push_back(&soa, make_row(42));
+    expected[n++] = 42;
+    CHECK(columns_aligned(&soa));
+    CHECK(in_sync(&soa, expected, n));
+
+    destructor_soa_array(soa);
+
+    printf("soa_array: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
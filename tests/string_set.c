@@ -0,0 +1,136 @@
+// Test for StringSet: ids and pointers stay stable while the table and arena grow,
+// get/find/length round-trip, oversized keys get a private chunk without abandoning
+// the current one, and keys are compared by length so embedded NULs and the empty
+// string are ordinary keys.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dynstrset.h"
+
+#define KEYS 20000
+
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static void test_empty(void)
+{
+    StringSet set = constructor_string_set();
+
+    CHECK(set.empty(&set));
+    CHECK(set.find(&set, "missing") == STRING_SET_NONE);
+    CHECK(set.find_n(&set, "", 0) == STRING_SET_NONE);
+    CHECK(!set.contains(&set, "missing"));
+
+    set.intern(&set, "alpha");
+    destructor_string_set(set);
+    CHECK(set.find(&set, "alpha") == STRING_SET_NONE);
+}
+
+static void test_stable_ids(void)
+{
+    StringSet set = constructor_string_set();
+    static const char* pointers[KEYS];
+    char key[32];
+
+    for (size_t i = 0; i < KEYS; i++)
+    {
+        snprintf(key, sizeof(key), "key-%zu", i);
+        CHECK(set.intern(&set, key) == i);
+        pointers[i] = set.get(&set, i);
+    }
+    CHECK(set.size(&set) == KEYS);
+
+    for (size_t i = 0; i < KEYS; i++)
+    {
+        snprintf(key, sizeof(key), "key-%zu", i);
+        CHECK(set.intern(&set, key) == i);
+        CHECK(set.find(&set, key) == i);
+        CHECK(set.get(&set, i) == pointers[i]);
+        CHECK(strcmp(set.get(&set, i), key) == 0);
+        CHECK(set.length(&set, i) == strlen(key));
+    }
+    CHECK(set.size(&set) == KEYS);
+    CHECK(set.find(&set, "key-") == STRING_SET_NONE);
+
+    destructor_string_set(set);
+}
+
+static void test_oversized_key(void)
+{
+    StringSet set = constructor_string_set();
+
+    size_t small = set.intern(&set, "small");
+    StringChunk* current = set._chunks;
+    size_t used = current->used;
+
+    size_t length = 2 * STRING_SET_CHUNK;
+    char* big = malloc(length + 1);
+    memset(big, 'x', length);
+    big[length] = '\0';
+
+    size_t id = set.intern(&set, big);
+    CHECK(set._chunks == current);
+    CHECK(current->used == used);
+    CHECK(current->next != NULL && current->next->capacity > length);
+    CHECK(set.length(&set, id) == length);
+    CHECK(memcmp(set.get(&set, id), big, length + 1) == 0);
+
+    // the next small key still goes into the chunk that was current before
+    size_t after = set.intern(&set, "after");
+    CHECK(set._chunks == current);
+    CHECK(current->used > used);
+    CHECK(strcmp(set.get(&set, small), "small") == 0);
+    CHECK(strcmp(set.get(&set, after), "after") == 0);
+
+    free(big);
+    destructor_string_set(set);
+}
+
+static void test_lengths(void)
+{
+    StringSet set = constructor_string_set();
+
+    size_t empty = set.intern_n(&set, "", 0);
+    size_t ab = set.intern_n(&set, "a\0b", 3);
+    size_t ac = set.intern_n(&set, "a\0c", 3);
+    size_t a = set.intern(&set, "a");
+
+    CHECK(empty != ab && ab != ac && ac != a && a != empty);
+    CHECK(set.size(&set) == 4);
+
+    CHECK(set.find(&set, "") == empty);
+    CHECK(set.length(&set, empty) == 0);
+    CHECK(set.get(&set, empty)[0] == '\0');
+
+    CHECK(set.find_n(&set, "a\0b", 3) == ab);
+    CHECK(set.find_n(&set, "a\0c", 3) == ac);
+    CHECK(set.find_n(&set, "a\0d", 3) == STRING_SET_NONE);
+    CHECK(set.length(&set, ab) == 3);
+    CHECK(memcmp(set.get(&set, ab), "a\0b", 4) == 0);
+
+    CHECK(set.find(&set, "a") == a);
+    CHECK(set.intern_n(&set, "a\0b", 3) == ab);
+    CHECK(set.size(&set) == 4);
+
+    destructor_string_set(set);
+}
+
+int main(void)
+{
+    test_empty();
+    test_stable_ids();
+    test_oversized_key();
+    test_lengths();
+
+    printf("string_set: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
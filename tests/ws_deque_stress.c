@@ -0,0 +1,87 @@
+// Stress test for WS_DEQUE: one owner pushing and popping in bursts large enough
+// to force several buffer growths, while THIEVES threads steal concurrently.
+// Every value must be taken exactly once.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "dynwsdeque.h"
+
+#define THIEVES 4
+#define ROUNDS 200
+#define BURST 5000
+
+WS_DEQUE(long)
+
+static ws_deque_long deq;
+static atomic_uchar* taken;
+static atomic_bool done;
+
+static void take(long value)
+{
+    atomic_fetch_add_explicit(&taken[value], 1, memory_order_relaxed);
+}
+
+static void* thief(void* arg)
+{
+    (void)arg;
+    long value;
+
+    while (!atomic_load(&done))
+    {
+        if (deq.steal(&deq, &value))
+            take(value);
+    }
+    while (deq.steal(&deq, &value))
+        take(value);
+
+    return NULL;
+}
+
+int main(void)
+{
+    long total = (long)ROUNDS * BURST;
+    taken = calloc((size_t)total, sizeof(*taken));
+    deq = (ws_deque_long)constructor_ws_deque(long);
+
+    pthread_t threads[THIEVES];
+    for (int i = 0; i < THIEVES; i++)
+        pthread_create(&threads[i], NULL, thief, NULL);
+
+    long next = 0, value;
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (int i = 0; i < BURST; i++)
+            deq.push(&deq, next++);
+        for (int i = 0; i < BURST / 2; i++)
+        {
+            if (deq.pop(&deq, &value))
+                take(value);
+        }
+    }
+    while (deq.pop(&deq, &value))
+        take(value);
+
+    atomic_store(&done, true);
+    for (int i = 0; i < THIEVES; i++)
+        pthread_join(threads[i], NULL);
+
+    long missing = 0, duplicated = 0;
+    for (long i = 0; i < total; i++)
+    {
+        unsigned char count = atomic_load(&taken[i]);
+        missing += count == 0;
+        duplicated += count > 1;
+    }
+
+    printf("values %ld, missing %ld, duplicated %ld\n", total, missing, duplicated);
+
+    destructor_ws_deque(deq);
+    free(taken);
+
+    return (missing == 0 && duplicated == 0) ? 0 : 1;
+}
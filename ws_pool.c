@@ -0,0 +1,213 @@
+// Work-stealing thread pool example / benchmark built on WS_DEQUE
+
+/*  Sums f(i) over [0, n) as a fork-join job: a range is split in half until it is
+    at most GRAIN long, one half is pushed for others to take and the worker carries
+    on with the other. The same job is run twice:
+
+        central - every worker shares one queue guarded by a pthread mutex
+        stealing - every worker owns a WS_DEQUE and steals from a random victim when idle
+
+    usage: ws_pool [threads] [n]
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "dynwsdeque.h"
+#include "dynqueue.h"
+
+#define GRAIN 1024
+#define MAX_THREADS 256
+
+typedef struct range
+{
+    long lo;
+    long hi;
+} range;
+
+// WS_DEQUE slots must be lock-free atomics, so ranges travel through it packed into 64 bits
+WS_DEQUE(uint64_t)
+QUEUE(range)
+
+static uint64_t pack(range r)
+{
+    return ((uint64_t)r.lo << 32) | (uint64_t)r.hi;
+}
+
+static range unpack(uint64_t task)
+{
+    range r = { (long)(task >> 32), (long)(task & 0xFFFFFFFFu) };
+    return r;
+}
+
+static long n_total;
+static int n_threads;
+static atomic_long remaining;
+static atomic_ullong total;
+
+static uint64_t work(long i)
+{
+    uint64_t x = (uint64_t)i * 0x9E3779B97F4A7C15ULL;
+    for (int k = 0; k < 32; k++)
+        x ^= (x << 7) ^ (x >> 9);
+    return x & 0xFF;
+}
+
+static uint64_t leaf(range r)
+{
+    uint64_t sum = 0;
+    for (long i = r.lo; i < r.hi; i++)
+        sum += work(i);
+    return sum;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// central queue
+
+static queue_range central;
+static pthread_mutex_t central_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void* central_worker(void* arg)
+{
+    (void)arg;
+    uint64_t sum = 0;
+
+    while (atomic_load(&remaining) > 0)
+    {
+        range r;
+        bool got = false;
+
+        pthread_mutex_lock(&central_lock);
+        if (!central.empty(&central))
+        {
+            r = central.front(&central);
+            central.pop(&central);
+            got = true;
+        }
+        pthread_mutex_unlock(&central_lock);
+
+        if (!got)
+            continue;
+
+        while (r.hi - r.lo > GRAIN)
+        {
+            long mid = r.lo + (r.hi - r.lo) / 2;
+            range half = { mid, r.hi };
+
+            pthread_mutex_lock(&central_lock);
+            central.push(&central, half);
+            pthread_mutex_unlock(&central_lock);
+
+            r.hi = mid;
+        }
+
+        sum += leaf(r);
+        atomic_fetch_sub(&remaining, r.hi - r.lo);
+    }
+
+    atomic_fetch_add(&total, sum);
+    return NULL;
+}
+
+// work stealing
+
+static ws_deque_uint64_t deques[MAX_THREADS];
+
+static void* stealing_worker(void* arg)
+{
+    int self = (int)(intptr_t)arg;
+    ws_deque_uint64_t* own = &deques[self];
+    unsigned int seed = (unsigned int)self * 2654435761u + 1;
+    uint64_t sum = 0;
+
+    while (atomic_load_explicit(&remaining, memory_order_relaxed) > 0)
+    {
+        uint64_t task;
+
+        if (!own->pop(own, &task))
+        {
+            int victim = rand_r(&seed) % n_threads;
+            if (victim == self || !deques[victim].steal(&deques[victim], &task))
+                continue;
+        }
+
+        range r = unpack(task);
+
+        while (r.hi - r.lo > GRAIN)
+        {
+            long mid = r.lo + (r.hi - r.lo) / 2;
+            range half = { mid, r.hi };
+            own->push(own, pack(half));
+            r.hi = mid;
+        }
+
+        sum += leaf(r);
+        atomic_fetch_sub_explicit(&remaining, r.hi - r.lo, memory_order_relaxed);
+    }
+
+    atomic_fetch_add(&total, sum);
+    return NULL;
+}
+
+static double run(void* (*worker)(void*))
+{
+    pthread_t threads[MAX_THREADS];
+
+    atomic_store(&remaining, n_total);
+    atomic_store(&total, 0);
+
+    double start = now();
+    for (int i = 0; i < n_threads; i++)
+        pthread_create(&threads[i], NULL, worker, (void*)(intptr_t)i);
+    for (int i = 0; i < n_threads; i++)
+        pthread_join(threads[i], NULL);
+
+    return now() - start;
+}
+
+int main(int argc, char** argv)
+{
+    n_threads = (argc > 1) ? atoi(argv[1]) : 4;
+    n_total = (argc > 2) ? atol(argv[2]) : 1L << 24;
+
+    if (n_threads < 1 || n_threads > MAX_THREADS || n_total < 1 || n_total > UINT32_MAX)
+    {
+        fprintf(stderr, "usage: %s [threads 1-%d] [n 1-%u]\n", argv[0], MAX_THREADS, UINT32_MAX);
+        return 1;
+    }
+
+    range job = { 0, n_total };
+
+    central = (queue_range)constructor_queue(range);
+    central.push(&central, job);
+    double central_time = run(central_worker);
+    uint64_t central_total = atomic_load(&total);
+    destructor(central);
+
+    for (int i = 0; i < n_threads; i++)
+        deques[i] = (ws_deque_uint64_t)constructor_ws_deque(uint64_t);
+    deques[0].push(&deques[0], pack(job));
+    double stealing_time = run(stealing_worker);
+    uint64_t stealing_total = atomic_load(&total);
+    for (int i = 0; i < n_threads; i++)
+        destructor_ws_deque(deques[i]);
+
+    printf("threads %d, n %ld\n", n_threads, n_total);
+    printf("central  %8.3f ms  sum %llu\n", central_time * 1e3, (unsigned long long)central_total);
+    printf("stealing %8.3f ms  sum %llu\n", stealing_time * 1e3, (unsigned long long)stealing_total);
+
+    return central_total == stealing_total ? 0 : 1;
+}